@@ -0,0 +1,67 @@
+/*!
+ @example main10.cc
+
+ The same file is read twice, the second time with a \f$ CR-RC^2 \f$ shaper followed by a moving average on all the channels. The filters are applied
+ while the events are read, so the charge is evaluated on the filtered waveforms with the usual methods.
+
+ */
+
+#include "../readWD.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TGraph.h"
+#include "TH1F.h"
+#include "TMultiGraph.h"
+
+using namespace std;
+
+void main10()
+{
+    DAQFile file("../data/testWDB3.bin");
+    WDBEvent event, filtered;
+
+    filtered.MakeConfig(file);
+    filtered.SetFilter(WaveformFilter::CRRC(4, 2).Add(WaveformFilter::MovingAverage(5)));
+
+    TH1F *h1 = new TH1F("h1", "amplitude", 100, -0.5, 0);
+    TH1F *h2 = new TH1F("h2", "amplitude, filtered", 100, -0.5, 0);
+    while (file >> event)
+    {
+        h1->Fill(event.GetChannel(0, 0).GetAmplitude());
+    }
+
+    file.Reset();
+    while (file >> filtered)
+    {
+        h2->Fill(filtered.GetChannel(0, 0).GetAmplitude());
+    }
+
+    auto c1 = new TCanvas("c1", "c1", 1);
+    h1->Draw();
+    h2->SetLineColor(kRed);
+    h2->Draw("same");
+
+    // Last waveform, before and after the filters
+    auto c2 = new TCanvas("c2", "c2", 1);
+    auto mg = new TMultiGraph();
+    auto &volts = event.GetChannel(0, 0).GetVolts();
+    auto &times = event.GetChannel(0, 0).GetTimes();
+    auto &volts_f = filtered.GetChannel(0, 0).GetVolts();
+    auto g1 = new TGraph(volts.size(), times.data(), volts.data());
+    auto g2 = new TGraph(volts_f.size(), times.data(), volts_f.data());
+    g2->SetLineColor(kRed);
+    mg->Add(g1, "L");
+    mg->Add(g2, "L");
+    mg->Draw("A");
+    c1->Update();
+    c2->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main10();
+    app.Run();
+    return 0;
+}
@@ -0,0 +1,64 @@
+/*!
+ @example main11.cc
+
+ The waveforms of the file are resampled on a uniform grid of 0.2 ns with @ref WaveformResampler. All the waveforms share the same grid, so they can be
+ summed point by point: the mean waveform is drawn together with the last waveform, before and after the resampling.
+
+ */
+
+#include "../readWDResample.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TGraph.h"
+#include "TMultiGraph.h"
+
+using namespace std;
+
+void main11()
+{
+    DAQFile file("../data/testWDB3.bin");
+    WDBEvent event;
+    WaveformResampler resampler(file, 0.2e-9, WaveformResampler::Interpolation::Cubic);
+
+    auto &grid = resampler.GetTimes();
+    vector<float> mean(grid.size(), 0);
+    int n = 0;
+    while (file >> event)
+    {
+        auto &volts = resampler.Resample(event, 0, 0);
+        for (size_t k = 0; k < volts.size(); ++k)
+        {
+            mean[k] += volts[k];
+        }
+        ++n;
+    }
+    for (auto &v : mean)
+    {
+        v /= n;
+    }
+
+    auto c1 = new TCanvas("c1", "c1", 1);
+    auto mg = new TMultiGraph();
+    auto &volts = event.GetChannel(0, 0).GetVolts();
+    auto &times = event.GetChannel(0, 0).GetTimes();
+    auto &volts_r = resampler.GetVolts(0, 0);
+    auto g1 = new TGraph(volts.size(), times.data(), volts.data());
+    auto g2 = new TGraph(volts_r.size(), grid.data(), volts_r.data());
+    auto g3 = new TGraph(mean.size(), grid.data(), mean.data());
+    g2->SetLineColor(kRed);
+    g3->SetLineColor(kBlue);
+    mg->Add(g1, "L");
+    mg->Add(g2, "L");
+    mg->Add(g3, "L");
+    mg->Draw("A");
+    c1->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main11();
+    app.Run();
+    return 0;
+}
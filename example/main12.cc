@@ -0,0 +1,73 @@
+/*!
+ @example main12.cc
+
+ The power spectrum of the waveforms is averaged over all the events with @ref WaveformSpectrum. The strongest line above 50 MHz is then removed with a
+ notch filter, set on the event so that it is applied while the file is read again, and the new power spectrum is drawn over the first one.
+
+ */
+
+#include "../readWDSpectrum.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TGraph.h"
+#include "TMultiGraph.h"
+
+using namespace std;
+
+void main12()
+{
+    DAQFile file("../data/testWDB3.bin");
+    WDBEvent event;
+    WaveformSpectrum spectrum(file);
+
+    while (file >> event)
+    {
+        spectrum.Accumulate(event);
+    }
+    auto &freq = spectrum.GetFrequencies();
+    auto power = spectrum.GetPowerSpectrum(0, 0);
+
+    size_t line = 1;
+    for (size_t k = 1; k < power.size(); ++k)
+    {
+        if (freq[k] > 50e6 and (freq[line] <= 50e6 or power[k] > power[line]))
+        {
+            line = k;
+        }
+    }
+    cout << "Strongest line at " << freq[line] / 1e6 << " MHz" << endl;
+
+    // Frequencies of the filters in units of the sampling frequency, i.e. the bin over the number of bins of the whole transform
+    float n = 2 * (power.size() - 1);
+    WDBEvent filtered;
+    filtered.MakeConfig(file);
+    filtered.SetFilter(WaveformFilter::Notch(line / n, 4 / n));
+
+    file.Reset();
+    spectrum.ResetPower();
+    while (file >> filtered)
+    {
+        spectrum.Accumulate(filtered);
+    }
+    auto power_f = spectrum.GetPowerSpectrum(0, 0);
+
+    auto c1 = new TCanvas("c1", "c1", 1);
+    c1->SetLogy();
+    auto mg = new TMultiGraph();
+    auto g1 = new TGraph(freq.size(), freq.data(), power.data());
+    auto g2 = new TGraph(freq.size(), freq.data(), power_f.data());
+    g2->SetLineColor(kRed);
+    mg->Add(g1, "L");
+    mg->Add(g2, "L");
+    mg->Draw("A");
+    c1->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main12();
+    app.Run();
+    return 0;
+}
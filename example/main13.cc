@@ -0,0 +1,52 @@
+/*!
+ @example main13.cc
+
+ The file ```data/split1-8at4GSPS``` of @ref main3.cc contains the same NIM signal split on channels 0 and 8. The delay between the two channels is
+ evaluated at each event with @ref DelayEstimator, from the cross-correlation of the whole pulses, and as the difference of the times at 50% constant
+ fraction: the two distributions are drawn together.
+
+ */
+
+#include "../readWDCorrelation.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TH1F.h"
+
+using namespace std;
+
+void main13()
+{
+    DAQFile file("../data/split1-8at4GSPS");
+    WDBEvent event;
+    DelayEstimator delays(file, {{{0, 0}, {0, 8}}});
+    delays.SetMaxDelay(5e-9);
+
+    auto h0 = new TH1F("xcorr", "delay, cross-correlation", 100, -1e-9, 1e-9);
+    auto h1 = new TH1F("cf", "delay, constant fraction", 100, -1e-9, 1e-9);
+    while (file >> event)
+    {
+        auto &d = delays.Evaluate(event);
+        if (delays.GetCorrelations()[0] < 0.9) // No pulse in one of the channels
+        {
+            continue;
+        }
+        h0->Fill(d[0]);
+        h1->Fill(event.GetChannel(0, 8).GetTimeCF(0.5) - event.GetChannel(0, 0).GetTimeCF(0.5));
+    }
+
+    auto c0 = new TCanvas("c0", "c0", 1);
+    h0->GetXaxis()->SetTitle("Time [s]");
+    h0->Draw();
+    h1->SetLineColor(kRed);
+    h1->Draw("same");
+    c0->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main13();
+    app.Run();
+    return 0;
+}
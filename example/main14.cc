@@ -0,0 +1,59 @@
+/*!
+ @example main14.cc
+
+ The template of the pulses of ```testWDB3.bin``` is averaged over the whole file with @ref TemplateFit::Average(), then every event is fitted with
+ it. The amplitude of the fit is compared with @ref DAQEvent::GetAmplitude(), the template is drawn.
+
+ */
+
+#include "../readWDTemplate.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TGraph.h"
+#include "TH1F.h"
+
+using namespace std;
+
+void main14()
+{
+    float period = 0.2e-9;
+    DAQFile file("../data/testWDB3.bin");
+    WDBEvent event;
+    TemplateFit fit(file, period);
+
+    auto shape = TemplateFit::Average(file, 0, 0, period, 10e-9, 30e-9);
+    fit.SetTemplate(shape);
+
+    TH1F *h1 = new TH1F("h1", "amplitude", 100, 0, 0.5);
+    TH1F *h2 = new TH1F("h2", "amplitude, template fit", 100, 0, 0.5);
+    while (file >> event)
+    {
+        h1->Fill(abs(event.GetChannel(0, 0).GetAmplitude()));
+        h2->Fill(fit.Fit(event, 0, 0).amplitude);
+    }
+
+    auto c1 = new TCanvas("c1", "c1", 1);
+    h1->Draw();
+    h2->SetLineColor(kRed);
+    h2->Draw("same");
+
+    vector<float> times(shape.size());
+    for (size_t k = 0; k < times.size(); ++k)
+    {
+        times[k] = k * period;
+    }
+    auto c2 = new TCanvas("c2", "c2", 1);
+    auto g = new TGraph(shape.size(), times.data(), shape.data());
+    g->Draw("AL");
+    c1->Update();
+    c2->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main14();
+    app.Run();
+    return 0;
+}
@@ -0,0 +1,56 @@
+/*!
+ @example main15.cc
+
+ The offset and the noise of each cell of the DRS chip are accumulated over the whole ```testWDB3.bin``` in one pass with @ref WaveformAverage,
+ without storing the waveforms, and drawn against the cell.
+
+ */
+
+#include "../readWDAverage.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TGraph.h"
+
+using namespace std;
+
+void main15()
+{
+    DAQFile file("../data/testWDB3.bin");
+    WDBEvent event;
+    WaveformAverage average(file, WaveformAverage::Alignment::Cell);
+
+    while (file >> event)
+    {
+        average.Add(event);
+    }
+
+    auto offset = average.GetMean(0, 0);
+    auto noise = average.GetRMS(0, 0);
+    vector<float> cells(offset.size());
+    for (size_t k = 0; k < cells.size(); ++k)
+    {
+        cells[k] = k;
+    }
+
+    auto c1 = new TCanvas("c1", "c1", 1);
+    c1->Divide(1, 2);
+    c1->cd(1);
+    auto g1 = new TGraph(cells.size(), cells.data(), offset.data());
+    g1->SetTitle("offset;cell;V");
+    g1->Draw("AL");
+    c1->cd(2);
+    auto g2 = new TGraph(cells.size(), cells.data(), noise.data());
+    g2->SetTitle("noise;cell;V");
+    g2->SetLineColor(kRed);
+    g2->Draw("AL");
+    c1->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main15();
+    app.Run();
+    return 0;
+}
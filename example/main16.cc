@@ -0,0 +1,55 @@
+/*!
+ @example main16.cc
+
+ The offsets of the cells are measured on ```testWDB3.bin```, which has no pulses, with @ref OffsetCalibration and written to a table. The table is read
+ back and set on the event, then the RMS of the waveforms is compared with and without the correction. The file was already corrected by the acquisition
+ software, so only the residual offsets are removed.
+
+ */
+
+#include "../readWDOffset.hh"
+#include "../readWDAverage.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TH1F.h"
+
+using namespace std;
+
+void main16()
+{
+    DAQFile file("../data/testWDB3.bin");
+    WDBEvent event;
+    OffsetCalibration(file).Write("offsets.txt");
+
+    TH1F *h1 = new TH1F("h1", "RMS of the waveforms", 100, 0, 0.005);
+    TH1F *h2 = new TH1F("h2", "RMS of the waveforms, offsets subtracted", 100, 0, 0.005);
+    for (auto h : {h1, h2})
+    {
+        if (h == h2)
+        {
+            event.SetOffsetCalibration(OffsetCalibration("offsets.txt"));
+        }
+        while (file >> event)
+        {
+            auto &stats = event.GetChannel(0, 0).GetStats();
+            int n = event.GetChannel(0, 0).GetVolts().size();
+            h->Fill(sqrt(stats.sum2 / n - pow(stats.sum / n, 2)));
+        }
+        file.Reset();
+    }
+
+    auto c1 = new TCanvas("c1", "c1", 1);
+    h1->Draw();
+    h2->SetLineColor(kRed);
+    h2->Draw("same");
+    c1->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main16();
+    app.Run();
+    return 0;
+}
@@ -0,0 +1,49 @@
+/*!
+ @example main17.cc
+
+ All the pulses of ```testWDB3.bin``` are searched with @ref PulseFinder: the number of pulses of each waveform and the time of each pulse are
+ histogrammed.
+
+ */
+
+#include "../readWDPulse.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TH1F.h"
+
+using namespace std;
+
+void main17()
+{
+    DAQFile file("../data/testWDB3.bin");
+    WDBEvent event;
+    PulseFinder finder(file, -0.005, 0.3);
+
+    TH1F *h1 = new TH1F("h1", "pulses per waveform", 10, 0, 10);
+    TH1F *h2 = new TH1F("h2", "time of the pulses", 100, 0, 200e-9);
+    while (file >> event)
+    {
+        auto &pulses = finder.Find(event, 0, 0);
+        h1->Fill(pulses.size());
+        for (auto &pulse : pulses)
+        {
+            h2->Fill(pulse.time);
+        }
+    }
+
+    auto c1 = new TCanvas("c1", "c1", 1);
+    h1->Draw();
+    auto c2 = new TCanvas("c2", "c2", 1);
+    h2->Draw();
+    c1->Update();
+    c2->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main17();
+    app.Run();
+    return 0;
+}
@@ -0,0 +1,41 @@
+/*!
+ @example main18.cc
+
+ The tail over total ratio of the waveforms of ```testWDB3.bin``` is evaluated with @ref PulseShapeDiscriminator, with gates starting 5 ns before the
+ time at 30% of the amplitude, and histogrammed against the charge of the long gate.
+
+ */
+
+#include "../readWDPSD.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TH2F.h"
+
+using namespace std;
+
+void main18()
+{
+    DAQFile file("../data/testWDB3.bin");
+    WDBEvent event;
+    PulseShapeDiscriminator psd(file, 5e-9, 20e-9, 100e-9, PulseShapeDiscriminator::Reference::CF, 0.3);
+
+    TH2F *h = new TH2F("h", "PSD;long gate charge [V s];tail / total", 100, -2e-9, 2e-9, 100, -1, 1);
+    while (file >> event)
+    {
+        auto &result = psd.Evaluate(event, 0, 0);
+        h->Fill(result.long_charge, result.ratio);
+    }
+
+    auto c1 = new TCanvas("c1", "c1", 1);
+    h->Draw("colz");
+    c1->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main18();
+    app.Run();
+    return 0;
+}
@@ -0,0 +1,47 @@
+/*!
+ @example main19.cc
+
+ The times of the edges of the waveforms of ```testWDB3.bin``` at 10%, 50% and 90% of the amplitude are evaluated with @ref EdgeTiming, and the
+ 10% - 90% rise time and the full width at half maximum are histogrammed.
+
+ */
+
+#include "../readWDTiming.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TH1F.h"
+
+using namespace std;
+
+void main19()
+{
+    DAQFile file("../data/testWDB3.bin");
+    WDBEvent event;
+    EdgeTiming timing(file, {}, {0.1, 0.5, 0.9});
+
+    TH1F *h_rise = new TH1F("h_rise", "Rise time;t_{90%} - t_{10%} [s];", 100, 0, 5e-9);
+    TH1F *h_width = new TH1F("h_width", "FWHM;t_{50%, trailing} - t_{50%, leading} [s];", 100, 0, 5e-9);
+    while (file >> event)
+    {
+        auto &edges = timing.Evaluate(event, 0, 0);
+        h_rise->Fill(edges[2].leading - edges[0].leading);
+        h_width->Fill(edges[1].trailing - edges[1].leading);
+    }
+
+    auto c1 = new TCanvas("c1", "c1", 1);
+    c1->Divide(2, 1);
+    c1->cd(1);
+    h_rise->Draw();
+    c1->cd(2);
+    h_width->Draw();
+    c1->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main19();
+    app.Run();
+    return 0;
+}
@@ -34,7 +34,7 @@ void main2(void)
             cout << "Pedestal = " << ped.first << " +/- " << ped.second << endl;
             cout << "#local minima = " << indices.size() << endl;
 
-            auto g1 = new TGraph(SAMPLES_PER_WAVEFORM, times.data(), volts.data());
+            auto g1 = new TGraph(volts.size(), times.data(), volts.data());
             auto g2 = new TGraph(indices.size(), m_times.data(), m_volts.data());
 
             g1->SetMarkerColor(kBlack);
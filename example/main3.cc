@@ -40,7 +40,7 @@ void main1()
         auto &times0 = event.GetChannel(0, 0).GetTimes();
         auto &times1 = event.GetChannel(0, 1).GetTimes();
 
-        for (int j = 0; j < SAMPLES_PER_WAVEFORM; ++j)
+        for (int j = 0; j < (int)times0.size(); ++j)
         {
             h0->Fill(times0[j] - times1[j]);
         }
@@ -54,7 +54,7 @@ void main1()
         auto &times0 = event.GetChannel(0, 0).GetTimes();
         auto &times8 = event.GetChannel(0, 8).GetTimes();
         
-        for (int j = 0; j < SAMPLES_PER_WAVEFORM; ++j)
+        for (int j = 0; j < (int)times0.size(); ++j)
         {
             h1->Fill(times0[j] - times8[j]);
         }
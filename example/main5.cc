@@ -0,0 +1,44 @@
+/*!
+ @example main5.cc
+
+ The file is read with `ROOT::RDataFrame` through @ref DAQDataSource, built by @ref MakeDAQDataFrame(). The implicit multithreading of ROOT is enabled:
+ the events are split in ranges and each thread reads its own range from the file. Only the columns used are evaluated, here the charge and the
+ amplitude of board 0, channel 0, and the waveform used to fill the histogram of the minimum voltage.
+
+ */
+
+#include "../readWDRDF.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TROOT.h"
+
+using namespace std;
+
+void main5()
+{
+    ROOT::EnableImplicitMT();
+
+    auto df = MakeDAQDataFrame("../data/testDRS.dat");
+    auto h1 = df.Histo1D({"h1", "charge histogram", 100, 0, 10}, "charge_b0_c0");
+    auto h2 = df.Histo1D({"h2", "amplitude histogram", 100, -0.5, 0}, "amplitude_b0_c0");
+    auto h3 = df.Define("vmin", "ROOT::VecOps::Min(volts_b0_c0)").Histo1D({"h3", "minimum voltage", 100, -0.5, 0.5}, "vmin");
+
+    auto c1 = new TCanvas("c1", "c1", 900, 300);
+    c1->Divide(3, 1);
+    c1->cd(1);
+    h1->DrawClone();
+    c1->cd(2);
+    h2->DrawClone();
+    c1->cd(3);
+    h3->DrawClone();
+    c1->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main5();
+    app.Run();
+    return 0;
+}
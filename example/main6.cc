@@ -0,0 +1,49 @@
+/*!
+ @example main6.cc
+
+ The file ```testWDB3.bin``` is converted into a readWD archive with @ref DAQArchive::Convert(), see @ref archive. The archive is then read
+ with @ref DAQArchive as it would be done with @ref DAQFile. Only board 0, channel 0 is selected with @ref DAQArchive::SetChannels(): the other channels
+ are not read from disk. At the end the method @ref DAQArchive::GetEvent() is used to jump directly to an event thanks to the index.
+
+ */
+
+#include "../readWDArchive.hh"
+
+#include "TApplication.h"
+#include "TGraph.h"
+#include "TH1F.h"
+
+using namespace std;
+
+void main6()
+{
+    DAQArchive::Convert("../data/testWDB3.bin", "../data/testWDB3.rwda", 100);
+
+    DAQArchive archive("../data/testWDB3.rwda");
+    WDBEvent event;
+
+    TH1F *h1 = new TH1F("h1", "amplitude histogram", 100, -0.5, 0);
+
+    archive.SetChannels({{0, 0}});
+    while (archive >> event)
+    {
+        h1->Fill(event.GetChannel(0, 0).GetAmplitude());
+    }
+    h1->Draw();
+
+    archive.GetEvent(500);
+    archive >> event;
+    auto times = event.GetChannel(0, 0).GetTimes();
+    auto volts = event.GetChannel(0, 0).GetVolts();
+
+    auto g1 = new TGraph(times.size(), times.data(), volts.data());
+    g1->Draw("SAME L");
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main6();
+    app.Run();
+    return 0;
+}
@@ -0,0 +1,64 @@
+/*!
+ @example main7.cc
+
+ Many runs are read as a single @ref DAQDataset built from a glob pattern. First the dataset is read sequentially as a single file, using the global
+ event number given by @ref DAQDataset::GetEventNumber(). Then the same dataset is processed in parallel with @ref DAQDataset::Process(): each thread fills
+ its own histogram, and the histograms are merged at the end.
+
+ */
+
+#include "../readWDDataset.hh"
+
+#include "TApplication.h"
+#include "TH1F.h"
+
+using namespace std;
+
+void main7()
+{
+    DAQDataset dataset("../data/split*");
+    WDBEvent event;
+
+    for (size_t i = 0; i < dataset.GetNFiles(); ++i)
+    {
+        auto &info = dataset.GetFileInfo(i);
+        cout << info.name << ": " << info.n_events << " events, first event " << info.first_event << endl;
+    }
+
+    TH1F *h1 = new TH1F("h1", "amplitude histogram", 100, -0.5, 0);
+    while (dataset >> event)
+    {
+        if (dataset.GetEventNumber() % 1000 == 0)
+        {
+            cout << "Global event: " << dataset.GetEventNumber() << " from file " << dataset.GetFileIndex() << endl;
+        }
+        h1->Fill(event.GetChannel(0, 0).GetAmplitude());
+    }
+
+    unsigned int n_threads = 4;
+    vector<TH1F *> h(n_threads);
+    for (unsigned int t = 0; t < n_threads; ++t)
+    {
+        h[t] = new TH1F(("h_" + to_string(t)).c_str(), "charge histogram", 100, 0, 10);
+    }
+
+    dataset.Process([&](WDBEvent &event, long evt, unsigned int thread)
+                    { h[thread]->Fill(event.GetChannel(0, 0).GetCharge()); },
+                    n_threads);
+
+    for (unsigned int t = 1; t < n_threads; ++t)
+    {
+        h[0]->Add(h[t]);
+    }
+
+    h1->Draw();
+    h[0]->Draw("SAMES");
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main7();
+    app.Run();
+    return 0;
+}
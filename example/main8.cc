@@ -0,0 +1,49 @@
+/*!
+ @example main8.cc
+
+ Online monitoring of a run still being written by the DAQ software. With @ref DAQFile::SetFollow() the file is read in follow mode: at the end of
+ file the reading waits for the next complete event instead of stopping. The histogram is updated on screen every 100 events, the reading stops
+ when no new event is written for 30 seconds.
+
+ */
+
+#include "../readWD.hh"
+
+#include "TApplication.h"
+#include "TCanvas.h"
+#include "TH1F.h"
+#include "TSystem.h"
+
+using namespace std;
+
+void main8()
+{
+    DAQFile file("../data/running.dat");
+    DRSEvent event;
+
+    auto c1 = new TCanvas("c1", "c1", 1);
+    TH1F *h1 = new TH1F("h1", "amplitude histogram", 100, -0.5, 0);
+    h1->Draw();
+
+    file.SetFollow(true, 200, 30000);
+    int i = 0;
+    while (file >> event)
+    {
+        h1->Fill(event.GetChannel(0, 0).GetAmplitude());
+        if (++i % 100 == 0)
+        {
+            c1->Modified();
+            c1->Update();
+            gSystem->ProcessEvents();
+        }
+    }
+    c1->Update();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main8();
+    app.Run();
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*!
+ @example main9.cc
+
+ The events are read by one thread and analysed by another. The events are taken from a @ref DAQEventPool, so after the pool is built no memory is
+ allocated: the reader fills a free event and passes its pointer through a queue, the analysis gives it back to the pool when done.
+
+ */
+
+#include "../readWDPool.hh"
+
+#include "TApplication.h"
+#include "TH1F.h"
+
+#include <condition_variable>
+#include <queue>
+#include <thread>
+
+using namespace std;
+
+void main9()
+{
+    DAQFile file("../data/testWDB3.bin");
+    WDBEvent prototype;
+    prototype.MakeConfig(file);
+    prototype.SetPedInterval(0, 200);
+
+    DAQEventPool<WDBEvent> pool(file, 16, prototype);
+    queue<WDBEvent *> events;
+    mutex m;
+    condition_variable cv;
+
+    TH1F *h1 = new TH1F("h1", "charge histogram", 100, 0, 10);
+    thread analysis([&]()
+                    {
+        while (true)
+        {
+            unique_lock<mutex> lock(m);
+            cv.wait(lock, [&]() { return !events.empty(); });
+            WDBEvent *event = events.front();
+            events.pop();
+            lock.unlock();
+
+            if (event == nullptr) // End of file
+            {
+                break;
+            }
+            h1->Fill(event->GetChannel(0, 0).GetCharge());
+            pool.Release(event);
+        } });
+
+    WDBEvent *event = pool.Acquire();
+    while (file >> *event)
+    {
+        {
+            lock_guard<mutex> lock(m);
+            events.push(event);
+        }
+        cv.notify_one();
+        event = pool.Acquire();
+    }
+    pool.Release(event);
+
+    {
+        lock_guard<mutex> lock(m);
+        events.push(nullptr);
+    }
+    cv.notify_one();
+    analysis.join();
+
+    h1->Draw();
+}
+
+int main(int argc, char **argv)
+{
+    TApplication app("ROOT Application", &argc, argv);
+    main9();
+    app.Run();
+    return 0;
+}
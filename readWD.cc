@@ -10,6 +10,10 @@
  */
 #include "readWD.hh"
 
+#include <chrono>
+#include <ctime>
+#include <thread>
+
 using namespace std;
 
 /*
@@ -58,6 +62,66 @@ ostream &operator<<(ostream &o, const EventHeader &eh) // cout << EventHeader
     return o;
 }
 
+/*!
+ @brief Function to print a @ref DAQSummary easily on stream::cout
+
+ @param o
+ @param summary
+ @return ostream&
+ */
+ostream &operator<<(ostream &o, const DAQSummary &summary) // cout << DAQSummary
+{
+    o << summary.filename << endl;
+    o << "Type: " << summary.type << (summary.is_lab ? " (LAB)" : "") << endl;
+    o << "Events: " << summary.n_events << (summary.truncated ? " (truncated)" : "") << endl;
+    if (summary.n_events > 0)
+    {
+        o << "Serial numbers: " << summary.first.serialNumber << " - " << summary.last.serialNumber << endl;
+        o << "Start: " << summary.first.year << "/" << summary.first.month << "/" << summary.first.day << " "
+          << summary.first.hour << ":" << summary.first.min << ":" << summary.first.sec << "." << summary.first.ms << endl;
+        o << "Time span: " << summary.time_span << " s, rate: " << summary.rate << " Hz" << endl;
+        o << "Samples per waveform: " << summary.n_samples << endl;
+    }
+    for (size_t i = 0; i < summary.board_serials.size(); ++i)
+    {
+        o << "B#" << summary.board_serials[i] << ":";
+        if (summary.channels.count(i))
+        {
+            for (auto c : summary.channels.at(i))
+            {
+                o << " C" << c;
+            }
+        }
+        o << endl;
+    }
+    o << "Gaps: " << summary.gaps.size();
+    for (auto &[before, after] : summary.gaps)
+    {
+        o << endl
+          << " --> " << before << " -> " << after;
+    }
+    return o;
+}
+
+/*!
+ @brief Function to evaluate the 64-bit FNV-1a hash of some bytes.
+
+ @param data The bytes.
+ @param size The number of bytes.
+ @param hash The hash to be updated, by default the offset basis of FNV-1a, to hash many buffers one after the other.
+ @return unsigned long long The hash.
+ */
+unsigned long long HashFNV(const void *data, size_t size, unsigned long long hash)
+{
+    auto bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 /*
   ┌─────────────────────────────────────────────────────────────────────────┐
   │ CLASSES : DAQEvent                                                      │
@@ -136,11 +200,41 @@ DAQEvent &DAQEvent::GetChannel(const int &board, const int &channel)
     exit(0);
 }
 
+/*!
+ @brief Allocate the buffers of the event for the boards and channels of a file.
+
+ @details The waveforms, the times and the indices of the peaks of every channel are allocated once, so that reading the events of the file and
+ analysing them does not allocate memory. If needed @ref DAQEvent::MakeConfig() is called.
+
+ @param file The file to be read.
+ @return DAQEvent&
+ */
+DAQEvent &DAQEvent::Reserve(DAQFile &file)
+{
+    if (!config_.is_makeconfig_)
+    {
+        config_.MakeConfig(file);
+    }
+
+    for (auto &[bKey, bVal] : file.GetTimeMap())
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            volts_[bKey][cKey].resize(file.GetNSamples());
+            times_[bKey][cKey].resize(file.GetNSamples());
+            stats_[bKey][cKey] = {};
+            tcell_[bKey][cKey] = 0;
+        }
+    }
+    indexMin_.reserve(file.GetNSamples());
+    return *this;
+}
+
 /*!
  @brief Function to set the interval where to perform pedestal evaluation.
 
  @details The function checks automatically which value in input is smaller to correctly order the pair passed. A first control is made to check
- if the inputs are in the correct boundary that is from 0 to @ref SAMPLES_PER_WAVEFORM. All these tasks are managed by @ref DAQConfig.
+ if the inputs are in the correct boundary that is from 0 to the number of samples of the waveforms (see @ref DAQFile::GetNSamples()). All these tasks are managed by @ref DAQConfig.
 
  @param a The first boundary index value.
  @param b The second boundary index value.
@@ -183,7 +277,7 @@ void DAQEvent::SetPeakThr(float thr)
 }
 
 /*!
- @brief Set the integration window passing two indices that go from 0 to @ref SAMPLES_PER_WAVEFORM.
+ @brief Set the integration window passing two indices that go from 0 to the number of samples of the waveforms.
 
  @details All these tasks are managed by @ref DAQConfig.
 
@@ -229,7 +323,7 @@ void DAQEvent::SetIntWindow(float a, float b)
     }
 
     auto &times = times_[ch_.first][ch_.second];
-    if (a < times[0] or a > b or b > times[SAMPLES_PER_WAVEFORM - 1])
+    if (a < times[0] or a > b or b > times.back())
     {
         cerr << "!! Error: invalid times passed as integration window" << endl;
         exit(0);
@@ -242,10 +336,57 @@ void DAQEvent::SetIntWindow(float a, float b)
     return;
 }
 
+/*!
+ @brief Set the filter applied to the waveforms as soon as they are read.
+
+ @details The filter is applied in place when the event is read, before any analysis: the pedestal, the peaks, the charge and the times are evaluated on the
+ filtered waveform, and @ref DAQEvent::GetVolts() returns it. If a channel was selected with @ref DAQEvent::GetChannel() only its filter is changed, otherwise
+ the filter is set for all the channels. An empty filter, `WaveformFilter()`, removes the filtering. All these tasks are managed by @ref DAQConfig.
+
+ @param filter The filter, see @ref WaveformFilter.
+ */
+void DAQEvent::SetFilter(const WaveformFilter &filter)
+{
+    if (is_getch_)
+    {
+        config_.SetFilter(filter, ch_.first, ch_.second);
+    }
+    else
+    {
+        config_.SetFilter(filter);
+    }
+    is_getch_ = false;
+    return;
+}
+
+/*!
+ @brief Set the offsets of the cells subtracted from the waveforms as soon as they are read.
+
+ @details The offset of the cell of each sample is subtracted while the ADC values are converted to Volts, see @ref DAQEvent::SetVolts(), so the
+ correction does not add a pass over the waveform. If a channel was selected with @ref DAQEvent::GetChannel() only its offsets are changed, otherwise
+ the offsets are set for all the channels. An empty table, `OffsetCalibration()`, removes the correction. All these tasks are managed by @ref DAQConfig.
+
+ @param calibration The table of the offsets, see @ref OffsetCalibration.
+ */
+void DAQEvent::SetOffsetCalibration(const OffsetCalibration &calibration)
+{
+    if (is_getch_)
+    {
+        config_.SetOffsetCalibration(calibration, ch_.first, ch_.second);
+    }
+    else
+    {
+        config_.SetOffsetCalibration(calibration);
+    }
+    is_getch_ = false;
+    return;
+}
+
 /*!
  @brief Check if in the selected channel there is (or not) saturation.
 
  @details The saturation is defined as any value greater than +0.499V or lower than -0.499V. One single point is enough to return true.
+ The check uses the @ref WaveformStats evaluated while reading, the waveform is scanned only if the extremes are in the first or last two samples.
 
  @return true
  @return false
@@ -264,7 +405,20 @@ bool DAQEvent::IsSaturated()
         exit(0);
     }
 
+    // The extremes of the waveform decide, unless they are found in the first or last two samples, which are not considered
+    auto &stats = stats_[ch_.first][ch_.second];
     auto &volts = volts_[ch_.first][ch_.second];
+    int n = volts.size();
+    bool low = stats.min < -0.499, high = stats.max > +0.499;
+    if (!low and !high)
+    {
+        return false;
+    }
+    if ((low and stats.argmin >= 2 and stats.argmin < n - 2) or (high and stats.argmax >= 2 and stats.argmax < n - 2))
+    {
+        return true;
+    }
+
     return any_of(volts.begin() + 2, volts.end() - 2, [](float val)
                   { return (val < -0.499) || (val > +0.499); });
 }
@@ -353,24 +507,25 @@ float DAQEvent::GetTime(float thr)
 
     auto &volts = volts_[ch_.first][ch_.second];
     auto &times = times_[ch_.first][ch_.second];
+    int n = volts.size();
     int i = 10;
 
     if (thr < ped_.first)
     {
-        while (volts[i] > thr && i < SAMPLES_PER_WAVEFORM - 10)
+        while (volts[i] > thr && i < n - 10)
         {
             ++i;
         }
     }
     else
     {
-        while (volts[i] < thr && i < SAMPLES_PER_WAVEFORM - 10)
+        while (volts[i] < thr && i < n - 10)
         {
             ++i;
         }
     }
 
-    if (i == SAMPLES_PER_WAVEFORM)
+    if (i == n)
     {
         return 0;
     }
@@ -502,6 +657,56 @@ const vector<float> &DAQEvent::GetTimes()
     return times_[ch_.first][ch_.second];
 }
 
+/*!
+ @brief Getter method read-only for the summary of the waveform selected.
+
+ @details The summary is evaluated while the waveform is read, see @ref WaveformStats.
+
+ @return const WaveformStats&
+ */
+const WaveformStats &DAQEvent::GetStats()
+{
+    if (!is_init_)
+    {
+        cerr << "!! Error: no event read yet" << endl;
+        exit(0);
+    }
+
+    if (!is_getch_)
+    {
+        cerr << "!! Error: select a channel with DAQEvent::GetChannel()" << endl;
+        exit(0);
+    }
+
+    is_getch_ = false;
+    return stats_[ch_.first][ch_.second];
+}
+
+/*!
+ @brief Getter method for the trigger cell of the waveform selected.
+
+ @details The trigger cell is the cell of the chip of the first sample, see @ref DAQEvent::TimeCalibration().
+
+ @return unsigned short
+ */
+unsigned short DAQEvent::GetTriggerCell()
+{
+    if (!is_init_)
+    {
+        cerr << "!! Error: no event read yet" << endl;
+        exit(0);
+    }
+
+    if (!is_getch_)
+    {
+        cerr << "!! Error: select a channel with DAQEvent::GetChannel()" << endl;
+        exit(0);
+    }
+
+    is_getch_ = false;
+    return tcell_[ch_.first][ch_.second];
+}
+
 /*!
  @brief
 
@@ -554,19 +759,121 @@ const pair<int, int> &DAQEvent::GetIntegrationBounds()
      \f[
         t_{ch}[i] = \sum_{j = 0}^{i - 1} dt_{ch}[(j + tCell)%1024]
      \f]
+     The readout starts from the trigger cell, so a waveform shorter than the chip (region of interest readout) takes the first cells after it, and
+     a longer one (cascaded channels) goes around the chip again.
 
      @param tCell Cell number at which the signal triggered the board. Found in the event header.
      @param times Array with time bin width.
+     @param n The number of samples of the waveform.
      @param i The index of the board.
      @param j The index of the channel.
  */
-DAQEvent &DAQEvent::TimeCalibration(const unsigned short &tCell, const std::vector<float> &times, int i, int j)
+DAQEvent &DAQEvent::TimeCalibration(const unsigned short &tCell, const std::vector<float> &times, int n, int i, int j)
 {
-    times_[i][j] = times;
+    tcell_[i][j] = tCell;
     vector<float> &times_ij = times_[i][j];
-    rotate(times_ij.begin(), times_ij.begin() + tCell, times_ij.end());
-    partial_sum(times_ij.begin(), times_ij.end(), times_ij.begin());
+    times_ij.resize(n);
+
+    size_t cells = times.size();
+    size_t c = tCell % cells;
+    float t = 0;
+    for (int k = 0; k < n; ++k)
+    {
+        t += times[c];
+        times_ij[k] = t;
+        if (++c == cells)
+        {
+            c = 0;
+        }
+    }
+
+    return *this;
+}
 
+/*!
+ @brief Function to convert the ADC values of a waveform to Volts.
+
+ @details The ADC values are converted as \f$ V = ADC / 65536 + rangeCenter / 1000 - 0.5 \f$, in the same loop the @ref WaveformStats of the waveform
+ are evaluated, so that the waveform is not scanned again by the analysis methods. If the offsets of the cells are set for the channel (see
+ @ref DAQEvent::SetOffsetCalibration()) the offset of the cell of each sample is subtracted in the conversion. If a filter is set for the channel (see
+ @ref DAQEvent::SetFilter()) the waveform is filtered after the conversion and the statistics are evaluated on the filtered waveform.
+
+ @param adc The ADC values.
+ @param tCell The trigger cell, the cell of the first sample.
+ @param n The number of samples of the waveform.
+ @param i The index of the board.
+ @param j The index of the channel.
+ */
+DAQEvent &DAQEvent::SetVolts(const unsigned short *adc, unsigned short tCell, int n, int i, int j)
+{
+    auto &volts = volts_[i][j];
+    auto &stats = stats_[i][j];
+    volts.resize(n);
+
+    // Single pass over the samples: the value of each sample is given by the conversion, or by the filtered waveform
+    auto eval = [&](auto value)
+    {
+        float vmin = value(0);
+        float vmax = vmin;
+        int imin = 0, imax = 0;
+        double sum = 0, sum2 = 0;
+        for (int s = 0; s < n; ++s)
+        {
+            float v = value(s);
+            volts[s] = v;
+            sum += v;
+            sum2 += v * v;
+            if (v < vmin)
+            {
+                vmin = v;
+                imin = s;
+            }
+            if (v > vmax)
+            {
+                vmax = v;
+                imax = s;
+            }
+        }
+        stats = {vmin, vmax, imin, imax, sum, sum2};
+    };
+
+    double center = eh_.rangeCenter / 1000.;
+    auto convert = [adc, center](int s) -> float
+    { return adc[s] / 65536. + center - 0.5; };
+
+    // The offsets of the cells from the trigger cell on, see DAQConfig::SetOffsetCalibration()
+    const float *offset = nullptr;
+    if (config_.is_offset_ and !config_.offset_[i][j].empty())
+    {
+        auto &cells = config_.offset_[i][j];
+        if (n > config_.n_samples_)
+        {
+            cerr << "!! Error: waveform of " << n << " samples, the offsets of the cells were set for " << config_.n_samples_ << endl;
+            exit(0);
+        }
+        offset = cells.data() + tCell % (cells.size() - config_.n_samples_);
+    }
+    auto calibrate = [adc, center, offset](int s) -> float
+    { return adc[s] / 65536. + center - 0.5 - offset[s]; };
+
+    if (config_.is_filter_ and !config_.filter_[i][j].IsEmpty())
+    {
+        for (int s = 0; s < n; ++s)
+        {
+            volts[s] = offset ? calibrate(s) : convert(s);
+        }
+        config_.filter_[i][j].Apply(volts.data(), n, filter_buf_);
+        eval([&volts](int s)
+             { return volts[s]; });
+    }
+    else if (offset)
+    {
+        eval(calibrate);
+    }
+    else
+    {
+        eval(convert);
+    }
     return *this;
 }
 
@@ -655,7 +962,7 @@ DAQEvent &DAQEvent::EvalIntegrationBounds()
             --iw_.first;
         }
 
-        while (volts[iw_.second] < lower_bound and iw_.second < SAMPLES_PER_WAVEFORM - 10)
+        while (volts[iw_.second] < lower_bound and iw_.second < (int)volts.size() - 10)
         {
             ++iw_.second;
         }
@@ -695,7 +1002,7 @@ DAQEvent &DAQEvent::FindPeaks()
     long index_min;
     auto &volts = volts_[ch_.first][ch_.second];
     auto &times = times_[ch_.first][ch_.second];
-    indexMin_ = {};
+    indexMin_.clear();
 
     iw_ = config_.intWindow_[ch_.first][ch_.second];
     peak_threshold_ = config_.peakThr_[ch_.first][ch_.second];
@@ -707,9 +1014,9 @@ DAQEvent &DAQEvent::FindPeaks()
     }
     else // No user integration window set
     {
-        index_min = distance(volts.begin() + 10, min_element(volts.begin() + 10, volts.end() - 10)) + 10;
+        index_min = (*this).GlobalMin();
         bool signal, min_left, min_right, at_least;
-        for (int i = 10; i < SAMPLES_PER_WAVEFORM - 10; ++i)
+        for (int i = 10; i < (int)volts.size() - 10; ++i)
         {
             signal = abs(volts[i] - ped_.first) > 5 * ped_.second;
             min_left = abs(volts[i]) > abs(volts[i - 1]) + ped_.second;
@@ -739,7 +1046,7 @@ DAQEvent &DAQEvent::FindPeaks()
 
     if (indexMin_.size() == 0) // Assure that at least global minimum is inserted in indexMin_
     {
-        index_min = distance(volts.begin() + 10, min_element(volts.begin() + 10, volts.end() - 10)) + 10;
+        index_min = (*this).GlobalMin();
         indexMin_.push_back(index_min);
     }
 
@@ -748,6 +1055,25 @@ DAQEvent &DAQEvent::FindPeaks()
     return *this;
 }
 
+/*!
+ @brief Method to find the global minimum of the selected waveform, excluding the first and last 10 samples.
+
+ @details The minimum of the @ref WaveformStats is used if it is inside the range, otherwise the range is scanned.
+
+ @return long The index of the first minimum.
+ */
+long DAQEvent::GlobalMin()
+{
+    auto &stats = stats_[ch_.first][ch_.second];
+    auto &volts = volts_[ch_.first][ch_.second];
+    if (stats.argmin >= 10 and stats.argmin < (int)volts.size() - 10)
+    {
+        return stats.argmin;
+    }
+
+    return distance(volts.begin() + 10, min_element(volts.begin() + 10, volts.end() - 10)) + 10;
+}
+
 /*
   ┌─────────────────────────────────────────────────────────────────────────┐
   │ CLASSES : DRSEvent                                                      │
@@ -788,13 +1114,16 @@ const string WDBEvent::type_ = "WDB";
 DAQConfig::DAQConfig()
 {
     is_makeconfig_ = false;
+    is_filter_ = false;
+    is_offset_ = false;
+    n_samples_ = SAMPLES_PER_WAVEFORM;
 }
 
 /*!
  @brief Initialise the configuration class with the default values for any board and any channel.
 
  @details The data members inside this class are initialised. The default values are the following:
-    - integration window: `[0, SAMPLES_PER_WAVEFORM - 1]`
+    - integration window: `[0, n - 1]`, with `n` the number of samples of the waveforms of the file
     - pedestal interval: `[0, 100]`
     - peak threshold: `+0.5V`
 
@@ -808,15 +1137,29 @@ void DAQConfig::MakeConfig(DAQFile &file)
         exit(0);
     }
 
+    (*this).MakeConfig(file.times_, file.n_samples_);
+}
+
+/*!
+ @brief Initialise the configuration class with the default values for the boards and channels of a time map.
+
+ @param times The map of times, only the board and channel keys are used.
+ @param n_samples The number of samples of the waveforms.
+ */
+void DAQConfig::MakeConfig(const map<int, map<int, vector<float>>> &times, int n_samples)
+{
     is_makeconfig_ = true;
-    for (auto &[bKey, bVal] : file.times_)
+    n_samples_ = n_samples;
+    for (auto &[bKey, bVal] : times)
     {
         for (auto &[cKey, cVal] : bVal)
         {
-            intWindow_[bKey][cKey] = {0, SAMPLES_PER_WAVEFORM - 1};
+            intWindow_[bKey][cKey] = {0, n_samples_ - 1};
             pedInterval_[bKey][cKey] = {0, 100};
             peakThr_[bKey][cKey] = +0.5;
             user_iw_[bKey][cKey] = false;
+            filter_[bKey][cKey] = WaveformFilter();
+            offset_[bKey][cKey].clear();
         }
     }
 }
@@ -835,7 +1178,9 @@ void DAQConfig::ShowConfig()
             cout << " - Board/Channel ID : " << bKey << "/" << cKey << endl
                  << "       - Integration window : (" << intWindow_[bKey][cKey].first << ", " << intWindow_[bKey][cKey].second << ")" << endl
                  << "       - Pedestal interval : (" << pedInterval_[bKey][cKey].first << ", " << pedInterval_[bKey][cKey].second << ")" << endl
-                 << "       - Peak threshold : " << cVal << " V" << endl;
+                 << "       - Peak threshold : " << cVal << " V" << endl
+                 << "       - Filter : " << filter_[bKey][cKey].GetNStages() << " stage(s)" << endl
+                 << "       - Cell offsets : " << (offset_[bKey][cKey].empty() ? "no" : "yes") << endl;
         }
     }
 }
@@ -857,10 +1202,10 @@ void DAQConfig::SetIntWindow(pair<int, int> intWindow, int b, int c)
         exit(0);
     }
 
-    if (intWindow.first < 0 || intWindow.first > intWindow.second || intWindow.second > SAMPLES_PER_WAVEFORM - 1)
+    if (intWindow.first < 0 || intWindow.first > intWindow.second || intWindow.second > n_samples_ - 1)
     {
         cerr << "!! Error : Integration window has invalid value" << endl
-             << " Values must be in interval (0, " << SAMPLES_PER_WAVEFORM << "), passed values are ( " << intWindow.first << ", " << intWindow.second << ")" << endl;
+             << " Values must be in interval (0, " << n_samples_ << "), passed values are ( " << intWindow.first << ", " << intWindow.second << ")" << endl;
         exit(0);
     }
 
@@ -893,10 +1238,10 @@ void DAQConfig::SetIntWindow(pair<int, int> intWindow)
         exit(0);
     }
 
-    if (intWindow.first < 0 || intWindow.first > intWindow.second || intWindow.second > SAMPLES_PER_WAVEFORM - 1)
+    if (intWindow.first < 0 || intWindow.first > intWindow.second || intWindow.second > n_samples_ - 1)
     {
         cerr << "!! Error : Integration window has invalid value" << endl
-             << " Values must be in interval (0, " << SAMPLES_PER_WAVEFORM << "), passed values are ( " << intWindow.first << ", " << intWindow.second << ")" << endl;
+             << " Values must be in interval (0, " << n_samples_ << "), passed values are ( " << intWindow.first << ", " << intWindow.second << ")" << endl;
         exit(0);
     }
 
@@ -927,10 +1272,10 @@ void DAQConfig::SetPedInterval(pair<int, int> pedInterval, int b, int c)
         exit(0);
     }
 
-    if (pedInterval.first < 0 || pedInterval.first > pedInterval.second || pedInterval.second > SAMPLES_PER_WAVEFORM - 1)
+    if (pedInterval.first < 0 || pedInterval.first > pedInterval.second || pedInterval.second > n_samples_ - 1)
     {
         cerr << "!! Error : Pedestal interval has invalid value" << endl
-             << " Values must be in interval (0, " << SAMPLES_PER_WAVEFORM << "), passed values are ( " << pedInterval.first << ", " << pedInterval.second << ")" << endl;
+             << " Values must be in interval (0, " << n_samples_ << "), passed values are ( " << pedInterval.first << ", " << pedInterval.second << ")" << endl;
         exit(0);
     }
 
@@ -961,10 +1306,10 @@ void DAQConfig::SetPedInterval(pair<int, int> pedInterval)
         exit(0);
     }
 
-    if (pedInterval.first < 0 || pedInterval.first > pedInterval.second || pedInterval.second > SAMPLES_PER_WAVEFORM - 1)
+    if (pedInterval.first < 0 || pedInterval.first > pedInterval.second || pedInterval.second > n_samples_ - 1)
     {
         cerr << "!! Error : Pedestal interval has invalid value" << endl
-             << " Values must be in interval (0, " << SAMPLES_PER_WAVEFORM << "), passed values are ( " << pedInterval.first << ", " << pedInterval.second << ")";
+             << " Values must be in interval (0, " << n_samples_ << "), passed values are ( " << pedInterval.first << ", " << pedInterval.second << ")";
         exit(0);
     }
 
@@ -1044,6 +1389,130 @@ void DAQConfig::SetPeakThr(float thr)
     }
 }
 
+/*!
+ @brief Method to set the filter given the filter and the board/channel IDs.
+
+ @details This method changes only the filter of the requested board/channel ID.
+
+ @param filter The filter.
+ @param b The board.
+ @param c The channel.
+ */
+void DAQConfig::SetFilter(const WaveformFilter &filter, int b, int c)
+{
+    if (is_makeconfig_ == false)
+    {
+        cerr << "!! Error : Configuration class not initialised, use DAQEvent::MakeConfig()" << endl;
+        exit(0);
+    }
+
+    if (filter_.find(b) != filter_.end())
+    {
+        if (filter_[b].find(c) != filter_[b].end())
+        {
+            filter_[b][c] = filter;
+            is_filter_ = true;
+            return;
+        }
+    }
+    cerr << "!! Error : Couldn't find board-channel of ID (" << b << ", " << c << ")" << endl;
+    exit(0);
+}
+
+/*!
+ @brief Method to set the filter given only the filter.
+
+ @details This method changes the filter for all boards and channels.
+
+ @param filter The filter.
+ */
+void DAQConfig::SetFilter(const WaveformFilter &filter)
+{
+    if (is_makeconfig_ == false)
+    {
+        cerr << "!! Error : Configuration class not initialised, use DAQEvent::MakeConfig()" << endl;
+        exit(0);
+    }
+
+    for (auto &[bKey, bVal] : filter_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            cVal = filter;
+        }
+    }
+    is_filter_ = true;
+}
+
+/*!
+ @brief Method to set the offsets of the cells given the table and the board/channel IDs.
+
+ @details This method changes only the offsets of the requested board/channel ID. The offsets are stored from the first cell to the last one and then
+ again from the first cell for the number of samples of the waveforms, so that the offsets of a waveform are contiguous from its trigger cell. The table
+ must have one offset for each cell of the ```TIME``` block, @ref SAMPLES_PER_WAVEFORM. If the table has no offsets for the channel its correction is removed.
+
+ @param calibration The table of the offsets.
+ @param b The board.
+ @param c The channel.
+ */
+void DAQConfig::SetOffsetCalibration(const OffsetCalibration &calibration, int b, int c)
+{
+    if (is_makeconfig_ == false)
+    {
+        cerr << "!! Error : Configuration class not initialised, use DAQEvent::MakeConfig()" << endl;
+        exit(0);
+    }
+
+    if (offset_.find(b) == offset_.end() or offset_[b].find(c) == offset_[b].end())
+    {
+        cerr << "!! Error : Couldn't find board-channel of ID (" << b << ", " << c << ")" << endl;
+        exit(0);
+    }
+
+    vector<float> &offset = offset_[b][c];
+    offset.clear();
+    if (calibration.HasOffsets(b, c))
+    {
+        const vector<float> &cells = calibration.GetOffsets(b, c);
+        if (cells.size() != SAMPLES_PER_WAVEFORM) // One offset for each cell of the TIME block
+        {
+            cerr << "!! Error: the table has " << cells.size() << " offsets for board-channel (" << b << ", " << c << "), expected one for each of the "
+                 << SAMPLES_PER_WAVEFORM << " cells" << endl;
+            exit(0);
+        }
+        offset.resize(cells.size() + n_samples_);
+        for (size_t k = 0; k < offset.size(); ++k)
+        {
+            offset[k] = cells[k % cells.size()];
+        }
+        is_offset_ = true;
+    }
+}
+
+/*!
+ @brief Method to set the offsets of the cells given only the table.
+
+ @details This method changes the offsets for all boards and channels, the channels without offsets in the table are not corrected.
+
+ @param calibration The table of the offsets.
+ */
+void DAQConfig::SetOffsetCalibration(const OffsetCalibration &calibration)
+{
+    if (is_makeconfig_ == false)
+    {
+        cerr << "!! Error : Configuration class not initialised, use DAQEvent::MakeConfig()" << endl;
+        exit(0);
+    }
+
+    for (auto &[bKey, bVal] : offset_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            (*this).SetOffsetCalibration(calibration, bKey, cKey);
+        }
+    }
+}
+
 /*
   ┌─────────────────────────────────────────────────────────────────────────┐
   │ CLASSES : DAQFile                                                       │
@@ -1059,6 +1528,18 @@ DAQFile::DAQFile()
     std::cout << "Created DAQFile, open a file using DAQFile::Open()" << endl;
     is_lab_ = 0;
     initialization_ = 0;
+    evt_size_ = 0;
+    follow_ = 0;
+    recovery_ = 0;
+    select_ = 0;
+    sel_range_ = 0;
+    sel_next_ = 0;
+    n_samples_ = SAMPLES_PER_WAVEFORM;
+    is_nsamples_ = 0;
+    layout_ = Layout::DRS;
+    read_event_ = nullptr;
+    read_raw_ = nullptr;
+    adc_.resize(n_samples_);
 }
 
 /*!
@@ -1073,12 +1554,26 @@ DAQFile::DAQFile(const string &fname)
     std::cout << "Created DAQFile, opened file " << fname << std::endl;
     initialization_ = 0;
     is_lab_ = 0;
+    evt_size_ = 0;
+    follow_ = 0;
+    recovery_ = 0;
+    select_ = 0;
+    sel_range_ = 0;
+    sel_next_ = 0;
+    n_samples_ = SAMPLES_PER_WAVEFORM;
+    is_nsamples_ = 0;
+    layout_ = Layout::DRS;
+    read_event_ = nullptr;
+    read_raw_ = nullptr;
+    adc_.resize(n_samples_);
     (*this).Initialise();
 }
 
 /*!
  @brief Initialise the file reading the **TIME** block.
 
+ @details If the same block was already read from another file, the calibration is taken from @ref DAQCalibration::Registry().
+
  @return DAQFile&
  */
 DAQFile &DAQFile::Initialise()
@@ -1136,13 +1631,29 @@ DAQFile &DAQFile::Initialise()
         return file;
     }
 
-    o_ = 'B';
-    int i = 0, j = 0;
+    auto time_pos = in_.tellg();
+    if (DAQCalibration::Registry().Reuse(in_, times_, board_serials_))
+    {
+        for (auto serial : board_serials_)
+        {
+            cout << "B#" << serial << ": calibration reused from registry" << endl;
+        }
+        cout << "Initialization done --> EHDR next" << endl;
+        o_ = 'C';
+        n_ = 'E';
+        initialization_ = true;
+        first_evt_pos_ = in_.tellg();
+        return file.SetLayout();
+    }
+
+    o_ = 'B';
+    int i = 0, j = 0;
     while (file >> bTag)
     {
         cout << bTag << ":" << endl;
+        board_serials_.push_back(*(unsigned short *)(bTag.tag + 2));
         j = 0;
-        while (file >> cTag)
+        while (file >> cTag and cTag.tag[0] == 'C') // The next B# ends the board
         {
             cout << " --> " << cTag << endl;
             file.Read(times);
@@ -1155,14 +1666,22 @@ DAQFile &DAQFile::Initialise()
 
     initialization_ = true;
     file.ResetTag();
+    if (!in_.good()) // No event written yet, the file is still being written by the DAQ
+    {
+        in_.clear();
+        in_.seekg(0, in_.end);
+    }
     first_evt_pos_ = in_.tellg();
+    DAQCalibration::Registry().Add(in_, time_pos, first_evt_pos_);
 
-    return file;
+    return file.SetLayout();
 }
 
 /*!
  @brief Method to close the file.
 
+ @details The informations read by @ref DAQFile::Initialise() are cleared, so that the same instance can be used to open another file.
+
  @return DAQFile&
  */
 DAQFile &DAQFile::Close()
@@ -1176,6 +1695,21 @@ DAQFile &DAQFile::Close()
     {
         cout << "File is already closed" << endl;
     }
+
+    // Forget the previous file so that DAQFile::Open() initialises the next one
+    initialization_ = 0;
+    is_lab_ = 0;
+    evt_size_ = 0;
+    n_samples_ = SAMPLES_PER_WAVEFORM;
+    is_nsamples_ = 0;
+    layout_ = Layout::DRS;
+    read_event_ = nullptr;
+    read_raw_ = nullptr;
+    type_.clear();
+    times_.clear();
+    board_serials_.clear();
+    skipped_.clear();
+    (*this).ClearSelection();
     return *this;
 }
 
@@ -1206,7 +1740,8 @@ DAQFile &DAQFile::Open(const string &fname)
 /*!
  @brief Method to reset the file.
 
- @details This method checks for file initialisation, in case it is not a warning is printed on screen. Otherwise the file goes back to first event header.
+ @details This method checks for file initialisation, in case it is not a warning is printed on screen. Otherwise the state of the stream is cleared
+ and the file goes back to first event header, so that it can be read again after the end of file was reached.
 
  @return DAQFile&
  */
@@ -1218,7 +1753,11 @@ DAQFile &DAQFile::Reset()
         return *this;
     }
 
+    in_.clear();
     in_.seekg(first_evt_pos_);
+    follow_pos_ = first_evt_pos_;
+    sel_range_ = 0;
+    sel_next_ = 0;
     return *this;
 }
 
@@ -1276,272 +1815,1675 @@ DAQFile &DAQFile::GetEvent(int evt_id)
         file.Read(eh);
         cout << eh << endl;
         in_.seekg(evt_id_pos);
+        follow_pos_ = evt_id_pos;
     }
 
     return file;
 }
 
 /*!
- @brief Read into a @ref TAG.
+ @brief Method to get the number of events stored in the file.
 
- @param t
- @return true
- @return false
+ @details The number of events is evaluated from the file size and from the size of a single event (see @ref DAQFile::EvalEventSize()),
+ no event is read. The current position in the file is left untouched.
+
+ @return long The number of events, 0 if the file is not initialised.
  */
-bool DAQFile::operator>>(TAG &t) // DAQFile >> TAG
+long DAQFile::GetNEvents()
 {
-    if (!in_.good())
+    if (!initialization_ or !in_.is_open())
     {
+        cerr << "!! Error: file not initialised --> use DAQFile::Open()" << endl;
         return 0;
     }
-    this->Read(t);
-    return *this;
+
+    auto state = in_.rdstate();
+    in_.clear();
+    auto pos = in_.tellg();
+    in_.seekg(0, in_.end);
+    long file_size = in_.tellg();
+    in_.seekg(pos);
+    in_.setstate(state);
+
+    return (file_size - first_evt_pos_) / (*this).EvalEventSize();
 }
 
 /*!
- @brief Read into a @ref EventHeader.
+ @brief Evaluate the time of an event header in milliseconds.
 
- @param eh
- @return true
- @return false
+ @param eh The event header.
+ @return double
  */
-bool DAQFile::operator>>(EventHeader &eh) // DAQFile >> EventHeader
+static double HeaderTime(const EventHeader &eh)
 {
-    if (!in_.good())
-    {
-        return 0;
-    }
-    this->Read(eh);
-    return *this;
+    tm t = {};
+    t.tm_year = eh.year - 1900;
+    t.tm_mon = eh.month - 1;
+    t.tm_mday = eh.day;
+    t.tm_hour = eh.hour;
+    t.tm_min = eh.min;
+    t.tm_sec = eh.sec;
+    return timegm(&t) * 1000. + eh.ms;
 }
 
 /*!
- @brief Read into a @ref DRSEvent.
+ @brief Method to get a summary of the file without decoding the events.
 
- @details This method reads exactly one event from the file to de DRSEvent class. A first check is made to check if the @ref DAQConfig class has been initialised,
- otherwise a call to @ref DAQEvent::MakeConfig() is made. In the nested while two things are done, the former is to ignore the time scaler if the DRS board is of type LAB-DRS (see @ref binary),
- the latter is to read and convert volts and to perform a time calibration. These data are stored in the @ref DAQEvent::times_ and @ref DAQEvent::volts_ maps.
+ @details The channel numbers are taken from the tags of the first event, jumping over the waveforms. Then only the header of each event is read:
+ since all the events have the same size (see @ref DAQFile::EvalEventSize()), the file is read with a separate unbuffered stream that jumps from
+ a header to the next one. The scan stops at the first header with an invalid tag. The current position in the file is left untouched.
 
- @param event
- @return true
- @return false
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ cout << file.Scan() << endl;
+ @endcode
+
+ @return DAQSummary
  */
-bool DAQFile::operator>>(DRSEvent &event) // DAQFile >> DRSEvent
+DAQSummary DAQFile::Scan()
 {
-    if (!in_.good())
-    {
-        return 0;
+    DAQSummary summary;
+    summary.filename = filename_;
+    summary.type = type_;
+    summary.is_lab = is_lab_;
+    summary.n_events = 0;
+    summary.truncated = false;
+    summary.first = {};
+    summary.last = {};
+    summary.time_span = 0;
+    summary.rate = 0;
+    summary.board_serials = board_serials_;
+    summary.n_samples = n_samples_;
+
+    if (!initialization_ or !in_.is_open())
+    {
+        cerr << "!! Error: file not initialised --> use DAQFile::Open()" << endl;
+        return summary;
+    }
+
+    ifstream in;
+    in.rdbuf()->pubsetbuf(nullptr, 0);
+    in.open(filename_, std::ios::in | std::ios::binary);
+    in.seekg(0, in.end);
+    long file_size = in.tellg();
+    long evt_size = (*this).EvalEventSize();
+    long n_events = (file_size - first_evt_pos_) / evt_size;
+    summary.truncated = (file_size - first_evt_pos_) % evt_size != 0;
+
+    // Channel numbers from the tags of the first event
+    if (n_events > 0)
+    {
+        long skip = n_samples_ * sizeof(unsigned short) + (is_lab_ ? 0 : sizeof(unsigned int)) + (type_ == "WDB" ? sizeof(TAG::tag) - 1 : 0);
+        TAG tag;
+        int i = -1;
+        in.seekg(first_evt_pos_ + sizeof(EventHeader));
+        while (in.tellg() < first_evt_pos_ + evt_size and in.read(tag.tag, 4))
+        {
+            if (tag.tag[0] == 'B' and tag.tag[1] == '#')
+            {
+                ++i;
+                if (type_ == "DRS")
+                {
+                    in.seekg(sizeof(TAG::tag) - 1, in.cur); // Trigger cell
+                }
+            }
+            else if (tag.tag[0] == 'C' and i >= 0)
+            {
+                summary.channels[i].push_back(atoi(string(tag.tag + 1, 3).c_str()));
+                in.seekg(skip, in.cur);
+            }
+            else
+            {
+                break;
+            }
+        }
     }
 
-    if (type_ != event.type_)
+    // Event headers only
+    EventHeader eh;
+    for (long k = 0; k < n_events; ++k)
     {
-        cerr << "!! Error: Invalid type of class used" << endl
-             << "Type expected: " << type_ << endl
-             << "Event given: " << event.type_ << endl;
-        exit(0);
+        in.seekg(first_evt_pos_ + k * evt_size);
+        in.read((char *)&eh, sizeof(EventHeader));
+        if (!in.good() or strncmp(eh.tag, "EHDR", 4) != 0)
+        {
+            cerr << "!! Error: invalid event header in " << filename_ << " at event " << k << ", scan stopped" << endl;
+            summary.truncated = true;
+            break;
+        }
+
+        if (k == 0)
+        {
+            summary.first = eh;
+        }
+        else if (eh.serialNumber != summary.last.serialNumber + 1)
+        {
+            summary.gaps.push_back({summary.last.serialNumber, eh.serialNumber});
+        }
+        summary.last = eh;
+        ++summary.n_events;
     }
 
-    if (!event.config_.is_makeconfig_)
+    if (summary.n_events > 0)
     {
-        cout << "Autocall to: DAQEvent::MakeConfig()...";
-        event.MakeConfig(*this);
-        cout << " Done!" << endl;
+        summary.time_span = (HeaderTime(summary.last) - HeaderTime(summary.first)) / 1000.;
+        if (summary.time_span > 0)
+        {
+            summary.rate = (summary.n_events - 1) / summary.time_span;
+        }
     }
 
-    DAQFile &file = *this;
-    TAG bTag, cTag, tag;
-    vector<float> volts(SAMPLES_PER_WAVEFORM);
-    int i = 0, j = 0;
+    return summary;
+}
 
-    // Read only one event
-    file >> event.eh_;
-    if (event.eh_.serialNumber % 100 == 0)
-    {
-        cout << "Event serial number: " << event.eh_.serialNumber << endl;
-    }
+/*!
+ @brief Select the events with serial number in a range.
 
-    event.is_init_ = true;
-    event.routine_ = {false, false, false};
+ @details The selections add up: the events selected by any call to @ref DAQFile::SelectSerials(), @ref DAQFile::SelectTime() and @ref DAQFile::SelectEvents()
+ are read, in the order of the file, and all the others are jumped over without being read. The selected events are found with a binary search on the event headers,
+ so the serial numbers and the times are assumed to increase along the file. After the selection the file goes back to the first selected event.
 
-    while (file >> bTag)
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+
+ file.SelectSerials(1000, 1999);
+ while (file >> event)
+ {
+     // ... only the events from 1000 to 1999
+ }
+ @endcode
+
+ @param first The first serial number selected.
+ @param last The last serial number selected, included.
+ @return DAQFile&
+ */
+DAQFile &DAQFile::SelectSerials(unsigned int first, unsigned int last)
+{
+    long i = (*this).FindEvent([first](const EventHeader &eh)
+                               { return eh.serialNumber >= first; });
+    long j = (*this).FindEvent([last](const EventHeader &eh)
+                               { return eh.serialNumber > last; });
+    return (*this).AddSelection(i, j);
+}
+
+/*!
+ @brief Select the events written in a time window.
+
+ @details The times are given in the same format of the event header, `year/month/day hour:min:sec.ms`, where the milliseconds are an optional integer as in the header,
+ e.g. `2022/01/12 17:54:20.500`. See @ref DAQFile::SelectSerials() for the details on the selections.
+
+ @param start The beginning of the window.
+ @param stop The end of the window, included.
+ @return DAQFile&
+ */
+DAQFile &DAQFile::SelectTime(const string &start, const string &stop)
+{
+    double window[2];
+    const string *str[2] = {&start, &stop};
+    for (int k = 0; k < 2; ++k)
     {
-        file >> tag; // Trigger cell
-        auto tCell = *(unsigned short *)(tag.tag + 2);
-        j = 0;
-        while (file >> cTag)
+        EventHeader eh = {};
+        int n = sscanf(str[k]->c_str(), "%hu/%hu/%hu %hu:%hu:%hu.%hu", &eh.year, &eh.month, &eh.day, &eh.hour, &eh.min, &eh.sec, &eh.ms);
+        if (n < 6)
         {
-            if (!is_lab_)
-            {
-                file >> tag; // Time scaler, LAB-DRS don't have time scaler
-            }
-            file.Read(volts, event.eh_.rangeCenter);
-            event.volts_[i][j] = volts;
-            event.TimeCalibration(tCell, times_[i][j], i, j);
-            ++j;
+            cerr << "!! Error: invalid time " << *str[k] << " --> expected year/month/day hour:min:sec.ms" << endl;
+            return *this;
         }
-        ++i;
-        file.ResetTag();
+        window[k] = HeaderTime(eh);
     }
-    file.ResetTag();
-    return 1;
+
+    long i = (*this).FindEvent([&window](const EventHeader &eh)
+                               { return HeaderTime(eh) >= window[0]; });
+    long j = (*this).FindEvent([&window](const EventHeader &eh)
+                               { return HeaderTime(eh) > window[1]; });
+    return (*this).AddSelection(i, j);
 }
 
 /*!
- @brief Read into a @ref WDBEvent.
+ @brief Select a list of events given their serial numbers.
 
- @details This method reads exactly one event from the file to de WDBEvent class. A first check is made to check if the @ref DAQConfig class has been initialised,
- otherwise a call to @ref DAQEvent::MakeConfig() is made. In the nested while volts are read and converted, then a time calibration is performed.
- These data are stored in the  @ref DAQEvent::times_ and @ref DAQEvent::volts_ maps.
+ @details The serial numbers not found in the file are ignored. See @ref DAQFile::SelectSerials() for the details on the selections.
 
- @param event
- @return true
- @return false
+ @param serials The serial numbers, in any order.
+ @return DAQFile&
  */
-bool DAQFile::operator>>(WDBEvent &event) // DAQFile >> WDBEvent
+DAQFile &DAQFile::SelectEvents(const vector<unsigned int> &serials)
 {
-    if (!in_.good())
-    {
-        return 0;
+    long n_events = (*this).GetNEvents();
+    for (auto serial : serials)
+    {
+        long i = (*this).FindEvent([serial](const EventHeader &eh)
+                                   { return eh.serialNumber >= serial; });
+        in_.clear();
+        in_.seekg(first_evt_pos_ + i * (*this).EvalEventSize());
+        EventHeader eh;
+        if (i < n_events and in_.read((char *)&eh, sizeof(EventHeader)) and eh.serialNumber == serial)
+        {
+            selection_.push_back({i, i + 1});
+        }
     }
+    return (*this).AddSelection(0, 0);
+}
 
-    if (type_ != event.type_)
-    {
-        cerr << "!! Error: Invalid type of class used" << endl
-             << "Type expected: " << type_ << endl
-             << "Event given: " << event.type_ << endl;
-        exit(0);
-    }
+/*!
+ @brief Remove the selections, all the events are read again.
 
-    if (!event.config_.is_makeconfig_)
-    {
-        cout << "Autocall to: DAQEvent::MakeConfig()...";
-        event.MakeConfig(*this);
-        cout << " Done!" << endl;
-    }
+ @return DAQFile&
+ */
+DAQFile &DAQFile::ClearSelection()
+{
+    select_ = 0;
+    selection_.clear();
+    sel_range_ = 0;
+    sel_next_ = 0;
+    return *this;
+}
 
-    DAQFile &file = *this;
-    TAG bTag, cTag, tag;
-    vector<float> volts(SAMPLES_PER_WAVEFORM);
-    int i = 0, j = 0;
+/*!
+ @brief Method to get the number of events selected.
 
-    // Read only one event
-    file >> event.eh_;
-    if (event.eh_.serialNumber % 100 == 0 and event.eh_.serialNumber > 0)
+ @return long The number of events selected, or the number of events in the file if there is no selection.
+ */
+long DAQFile::GetNSelected()
+{
+    if (!select_)
     {
-        cout << "Event serial number: " << event.eh_.serialNumber << endl;
+        return (*this).GetNEvents();
     }
 
-    event.is_init_ = true;
-    event.routine_ = {false, false, false};
-
-    while (file >> bTag)
+    long n = 0;
+    for (auto &[first, last] : selection_)
     {
-        j = 0;
-        while (file >> cTag)
-        {
-            file >> tag; // Time scaler
-            file >> tag; // Trigger cell
-            auto tCell = *(unsigned short *)(tag.tag + 2);
-            file.Read(volts, event.eh_.rangeCenter);
-            event.volts_[i][j] = volts;
-            event.TimeCalibration(tCell, times_[i][j], i, j);
-            ++j;
-        }
-        file.ResetTag();
-        ++i;
+        n += last - first;
     }
-    file.ResetTag();
-    return 1;
+    return n;
 }
 
 /*!
- @brief Read a tag.
+ @brief Find the first event whose header satisfies a condition.
 
- @param t
+ @details The events are searched with a binary search, reading only the event headers, so the condition must be false for all the events before the
+ one found and true for all the events after it.
+
+ @param cond The condition on the @ref EventHeader.
+ @return long The number of the event, starting from 0, or the number of events if the condition is always false.
  */
-void DAQFile::Read(TAG &t)
+template <typename F>
+long DAQFile::FindEvent(F cond)
 {
-    in_.read(t.tag, 4);
-    n_ = t.tag[0];
-    return;
+    long lo = 0, hi = (*this).GetNEvents();
+    long evt_size = (*this).EvalEventSize();
+    EventHeader eh;
+    while (lo < hi)
+    {
+        long mid = lo + (hi - lo) / 2;
+        in_.clear();
+        in_.seekg(first_evt_pos_ + mid * evt_size);
+        in_.read((char *)&eh, sizeof(EventHeader));
+        if (cond(eh))
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    return lo;
 }
 
 /*!
- @brief Read an event header.
+ @brief Add a range of events to the selection.
 
- @param eh
+ @details The ranges are kept sorted and merged, then the file goes back to the first selected event.
+
+ @param first The number of the first event, starting from 0.
+ @param last The number of the event after the last one.
+ @return DAQFile&
  */
-void DAQFile::Read(EventHeader &eh)
+DAQFile &DAQFile::AddSelection(long first, long last)
 {
-    in_.read((char *)&eh, sizeof(eh));
-    n_ = eh.tag[0];
+    select_ = 1;
+    if (first < last)
+    {
+        selection_.push_back({first, last});
+    }
+
+    sort(selection_.begin(), selection_.end());
+    vector<pair<long, long>> merged;
+    for (auto &range : selection_)
+    {
+        if (!merged.empty() and range.first <= merged.back().second)
+        {
+            merged.back().second = max(merged.back().second, range.second);
+        }
+        else
+        {
+            merged.push_back(range);
+        }
+    }
+    selection_ = merged;
+
+    (*this).Reset();
+    return *this;
 }
 
 /*!
- @brief Read a vector of float.
+ @brief Move the stream to the next selected event.
 
- @param vec
+ @return true
+ @return false There are no more selected events.
  */
-void DAQFile::Read(vector<float> &vec)
+bool DAQFile::NextSelected()
 {
-    for (int i = 0; i < vec.size(); ++i)
+    while (sel_range_ < selection_.size() and sel_next_ >= selection_[sel_range_].second)
     {
-        in_.read((char *)&vec.at(i), sizeof(float));
+        ++sel_range_;
+    }
+    if (sel_range_ >= selection_.size())
+    {
+        return 0;
     }
-    return;
-}
 
-/*!
- @brief Read a vector of voltages.
+    sel_next_ = max(sel_next_, selection_[sel_range_].first);
+    if (!follow_ and sel_next_ >= (*this).GetNEvents())
+    {
+        return 0;
+    }
 
- @details The reading of a vector of voltages implies also the trasformation from integer to Volts, and the shift due to the range center.
+    long pos = first_evt_pos_ + sel_next_ * (*this).EvalEventSize();
+    in_.clear();
+    in_.seekg(pos);
+    follow_pos_ = pos;
+    ++sel_next_;
+    return 1;
+}
 
- @param vec
- @param range_center
+/*!
+ @brief Set a condition on a trigger channel, evaluated before the other channels are read.
+
+ @details When a condition is set, for each event only the event header and the trigger channel are read and time calibrated first, then the condition is
+ evaluated on the event. Only if it is true the other channels are read, otherwise the event is jumped over. Inside the condition only the trigger channel
+ can be analysed, the other channels still hold the values of the previous event read.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+
+ file.SetTrigger(0, 3, [](DAQEvent &e)
+                 { return e.GetChannel(0, 3).GetAmplitude() < -0.05; });
+ while (file >> event)
+ {
+     // ... only the events with a signal on channel 3
+ }
+ @endcode
+
+ @param board The index of the board of the trigger channel.
+ @param channel The index of the trigger channel in the board.
+ @param cond The condition, an empty function to read again all the events.
+ @return DAQFile&
  */
-void DAQFile::Read(vector<float> &vec, const unsigned short &range_center)
+DAQFile &DAQFile::SetTrigger(int board, int channel, const function<bool(DAQEvent &)> &cond)
 {
-    unsigned short val;
-    for (int i = 0; i < vec.size(); ++i)
+    if (times_.find(board) == times_.end() or times_[board].find(channel) == times_[board].end())
     {
-        in_.read((char *)&val, sizeof(unsigned short));
-        vec[i] = val / 65536. + range_center / 1000. - 0.5;
+        cerr << "!! Error: invalid trigger channel (" << board << ", " << channel << ")" << endl;
+        exit(0);
     }
-    return;
+
+    int tag_size = sizeof(TAG::tag) - 1;
+    int wf_size = n_samples_ * sizeof(unsigned short);
+    int ch_size = tag_size + (is_lab_ ? 0 : tag_size) + (type_ == "WDB" ? tag_size : 0) + wf_size; // C, scaler, T# for WDB, waveform
+
+    long pos = sizeof(EventHeader);
+    for (auto &[bKey, bVal] : times_)
+    {
+        if (bKey == board)
+        {
+            break;
+        }
+        pos += tag_size + (type_ == "DRS" ? tag_size : 0) + bVal.size() * ch_size;
+    }
+
+    if (type_ == "DRS")
+    {
+        trig_tcell_pos_ = pos + tag_size; // After B#
+        pos += 2 * tag_size + channel * ch_size;
+        trig_wf_pos_ = pos + tag_size + (is_lab_ ? 0 : tag_size);
+    }
+    else
+    {
+        pos += tag_size + channel * ch_size;
+        trig_tcell_pos_ = pos + 2 * tag_size; // After C and scaler
+        trig_wf_pos_ = pos + 3 * tag_size;
+    }
+
+    trig_ch_ = {board, channel};
+    trig_pred_ = cond;
+    return *this;
 }
 
 /*!
- @brief The evaluation of boolean for the class DAQFile.
+ @brief Read the trigger channel of the next event and evaluate the condition.
 
- @details This method evaluates all the valid possible combinations of consecutive tags to determine if the value to return is 1 or 0.
- It uses the same principle of a finite state machine with the usage of a map named **header**, where the combinations of key-value match the
- possible configurations of consecutive non-equal tags that can be found in the binary file.
+ @details If the condition is true the stream is moved back to the beginning of the event, otherwise to the beginning of the next one.
 
+ @param event The event, only its header and the trigger channel are filled.
  @return true
- @return false
+ @return false The condition is false, or the event could not be read.
  */
-DAQFile::operator bool()
+bool DAQFile::PassTrigger(DAQEvent &event)
 {
-    map<char, char> header{{'E', 'B'}, {'B', 'C'}, {'C', 'B'}};
+    long pos = in_.tellg();
+    TAG tag;
+
+    in_.read((char *)&event.eh_, sizeof(EventHeader));
+    in_.seekg(pos + trig_tcell_pos_);
+    in_.read(tag.tag, 4);
+    auto tCell = *(unsigned short *)(tag.tag + 2);
+
+    in_.seekg(pos + trig_wf_pos_);
+    (*this).Read(adc_);
     if (!in_.good())
     {
-        cout << "End of file reached" << endl;
         return 0;
     }
-    else if (n_ == 'T' or n_ == 'D') // Ignores DRSx and TIME
-        return 0;
-    else if (n_ == o_) // C --> C, B --> B
-        return 1;
-    else if (n_ == header[o_]) // E --> B, B --> C, C --> B
+
+    event.is_init_ = true;
+    event.routine_ = {false, false, false};
+    event.SetVolts(adc_.data(), tCell, n_samples_, trig_ch_.first, trig_ch_.second);
+    event.TimeCalibration(tCell, times_[trig_ch_.first][trig_ch_.second], n_samples_, trig_ch_.first, trig_ch_.second);
+
+    if (trig_pred_(event))
     {
-        o_ = n_;
+        in_.seekg(pos);
         return 1;
     }
-    else if (n_ == 'E' and initialization_ == 0) // End of initialization, first EHDR
-    {
-        cout << "Initialization done --> EHDR next" << endl;
-        initialization_ = 1;
-        return 0;
-    }
+    in_.seekg(pos + (*this).EvalEventSize());
     return 0;
 }
+
+/*!
+ @brief Evaluate the size in bytes of a single event.
+
+ @details The size is evaluated from the boards and channels found in the ```TIME``` block, following the binary structure described in @ref binary:
+    - DRS: event header, then for each board `B#` and `T#`, then for each channel `C`, time scaler (not for LAB-DRS) and waveform.
+    - WDB: event header, then for each board `B#`, then for each channel `C`, time scaler, `T#` and waveform.
+
+ The waveforms have @ref DAQFile::n_samples_ samples. The value is evaluated once and then stored in @ref DAQFile::evt_size_.
+
+ @return int The size of an event in bytes.
+ */
+int DAQFile::EvalEventSize()
+{
+    if (evt_size_ > 0)
+    {
+        return evt_size_;
+    }
+
+    int ch_size = sizeof(TAG::tag) - 1 + n_samples_ * sizeof(unsigned short); // C + waveform
+    int tag_size = sizeof(TAG::tag) - 1;
+
+    evt_size_ = sizeof(EventHeader);
+    for (auto &[bKey, bVal] : times_)
+    {
+        if (type_ == "WDB")
+        {
+            evt_size_ += tag_size + bVal.size() * (ch_size + 2 * tag_size); // B#, then scaler and T# for each channel
+        }
+        else
+        {
+            evt_size_ += 2 * tag_size + bVal.size() * (ch_size + (is_lab_ ? 0 : tag_size)); // B# and T#, scaler if not LAB-DRS
+        }
+    }
+
+    return evt_size_;
+}
+
+/*!
+ @brief Set the follow mode, to read a file that is still being written by the DAQ.
+
+ @details In follow mode the end of file does not stop the reading: before each event the file size is checked, and if a complete event is not yet
+ available the method waits, polling the file, until the DAQ appends it. A partially written event is never read. The reading stops only if no new event
+ is appended within the timeout.
+
+ @code{.cpp}
+ DAQFile file("path/to/running.dat");
+ DRSEvent event;
+
+ file.SetFollow(true, 200, 60000); // Poll every 200 ms, stop after 1 minute without new events
+ while (file >> event)
+ {
+     // ...
+ }
+ @endcode
+
+ @param follow True to enable the follow mode.
+ @param poll_ms Time in milliseconds between two checks of the file size.
+ @param timeout_ms Time in milliseconds without new events after which the reading stops, negative to wait forever.
+ @return DAQFile&
+ */
+DAQFile &DAQFile::SetFollow(bool follow, int poll_ms, int timeout_ms)
+{
+    follow_ = follow;
+    poll_ms_ = max(1, poll_ms);
+    timeout_ms_ = timeout_ms;
+
+    if (follow_)
+    {
+        auto pos = in_.tellg();
+        follow_pos_ = pos < 0 ? first_evt_pos_ : (long)pos;
+    }
+    return *this;
+}
+
+/*!
+ @brief Check that the next event can be read.
+
+ @details Outside the follow mode it just checks the state of the stream. In follow mode the method waits until a complete event is available
+ after the position of the next event (see @ref DAQFile::SetFollow()), then it moves the stream there. If the file was opened before the first event was
+ written, the number of samples of the waveforms and the readers are set here (see @ref DAQFile::SetLayout()), as soon as two event headers or a complete event are written. If a selection is set the next event is the next
+selected one, see @ref DAQFile::SelectSerials(). In recovery mode the stream is then moved to the next
+ valid event, see @ref DAQFile::SetRecovery().
+
+ @return true
+ @return false
+ */
+bool DAQFile::WaitEvent()
+{
+    if (select_ and !(*this).NextSelected())
+    {
+        return 0;
+    }
+
+    if (!follow_)
+    {
+        if (!recovery_ or !initialization_ or !in_.is_open())
+        {
+            return in_.good();
+        }
+        in_.clear();
+        auto pos = in_.tellg();
+        in_.seekg(0, in_.end);
+        long file_size = in_.tellg();
+        in_.seekg(pos);
+        return (*this).Resync(file_size);
+    }
+
+    if (!initialization_ or !in_.is_open())
+    {
+        return 0;
+    }
+
+    int waited = 0;
+    while (true)
+    {
+        if (!is_nsamples_) // No complete event when the file was opened, the size of the events is not known yet
+        {
+            (*this).SetLayout();
+        }
+
+        long evt_size = (*this).EvalEventSize();
+        in_.clear();
+        in_.seekg(0, in_.end);
+        long file_size = in_.tellg();
+        if (is_nsamples_ and file_size - follow_pos_ >= evt_size)
+        {
+            in_.seekg(follow_pos_);
+            if (!recovery_ or (*this).Resync(file_size))
+            {
+                follow_pos_ = (long)in_.tellg() + evt_size;
+                return 1;
+            }
+            follow_pos_ = in_.tellg(); // No valid event in the data written so far, wait for more
+        }
+
+        if (timeout_ms_ >= 0 and waited >= timeout_ms_)
+        {
+            cout << "No new events in " << filename_ << " after " << waited << " ms, stop following" << endl;
+            in_.seekg(follow_pos_);
+            return 0;
+        }
+
+        this_thread::sleep_for(chrono::milliseconds(poll_ms_));
+        waited += poll_ms_;
+    }
+}
+
+/*!
+ @brief Set the recovery mode, to read files with corrupted or truncated events.
+
+ @details In recovery mode the structure of each event is checked before it is read (see @ref DAQFile::IsValidEvent()). If the event is not valid the file is
+ searched forward for the next valid event header, the bytes in between are skipped and a warning is printed. The skipped regions can be retrieved with
+ @ref DAQFile::GetSkipped(). A truncated event at the end of the file is skipped as well.
+
+ @code{.cpp}
+ DAQFile file("path/to/damaged.dat");
+ DRSEvent event;
+
+ file.SetRecovery(true);
+ while (file >> event)
+ {
+     // ...
+ }
+ for (auto &[pos, size] : file.GetSkipped())
+ {
+     cout << "Skipped " << size << " bytes at " << pos << endl;
+ }
+ @endcode
+
+ @param recovery True to enable the recovery mode.
+ @return DAQFile&
+ */
+DAQFile &DAQFile::SetRecovery(bool recovery)
+{
+    recovery_ = recovery;
+    return *this;
+}
+
+/*!
+ @brief Move the stream to the next valid event.
+
+ @details If the event at the current position is valid, and no other event starts inside it, the stream is left there. Otherwise the file is read in blocks and searched for the letter `E`
+ with `memchr` (vectorised by the C library), every `EHDR` found is checked with @ref DAQFile::IsValidEvent() and the stream is moved to the first valid one.
+ The bytes skipped are added to @ref DAQFile::skipped_, merged with the previous region if contiguous.
+
+ @param file_size The size of the file, only the data before it is searched.
+ @return true The stream is at the beginning of a valid event.
+ @return false No valid event found. In follow mode the stream is left at the first position from which the search must go on when more data is written.
+ */
+bool DAQFile::Resync(long file_size)
+{
+    long evt_size = (*this).EvalEventSize();
+    long pos = in_.tellg();
+    auto &evt = resync_buf_;
+    evt.resize(evt_size);
+
+    // A truncated event has its size made up by the following one: the header of another event must not be found inside it
+    auto valid = [&](long p)
+    {
+        if (p + evt_size > file_size)
+        {
+            return false;
+        }
+        in_.clear();
+        in_.seekg(p);
+        in_.read(evt.data(), evt_size);
+        if (!in_.good() or !(*this).IsValidEvent(evt.data()))
+        {
+            return false;
+        }
+        const char *end = evt.data() + evt_size - sizeof(EventHeader) - 4;
+        for (const char *c = evt.data() + 1; c < end; ++c)
+        {
+            c = (const char *)memchr(c, 'E', end - c);
+            if (c == nullptr)
+            {
+                break;
+            }
+            if (memcmp(c, "EHDR", 4) == 0 and c[sizeof(EventHeader)] == 'B' and c[sizeof(EventHeader) + 1] == '#' and
+                *(const unsigned short *)(c + sizeof(EventHeader) + 2) == board_serials_[0])
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (valid(pos))
+    {
+        in_.seekg(pos);
+        return 1;
+    }
+
+    long found = -1;
+    vector<char> block(RESYNC_BLOCK + 3);
+    for (long p = pos + 1; found < 0 and p + evt_size <= file_size; p += RESYNC_BLOCK)
+    {
+        in_.clear();
+        in_.seekg(p);
+        in_.read(block.data(), min<long>(block.size(), file_size - p));
+        long n = in_.gcount();
+        const char *end = block.data() + n - 3;
+        for (const char *c = block.data(); found < 0 and c < end; ++c)
+        {
+            c = (const char *)memchr(c, 'E', end - c);
+            if (c == nullptr)
+            {
+                break;
+            }
+            if (memcmp(c, "EHDR", 4) == 0 and valid(p + (c - block.data())))
+            {
+                found = p + (c - block.data());
+            }
+        }
+    }
+
+    long resume = found >= 0 ? found : (follow_ ? max(pos, file_size - evt_size + 1) : file_size);
+    if (resume > pos)
+    {
+        if (!skipped_.empty() and skipped_.back().first + skipped_.back().second == pos)
+        {
+            skipped_.back().second += resume - pos;
+        }
+        else
+        {
+            skipped_.push_back({pos, resume - pos});
+            cerr << "!! Warning: corrupted data in " << filename_ << " at byte " << pos << ", skipped " << resume - pos << " bytes" << endl;
+        }
+    }
+
+    in_.clear();
+    in_.seekg(resume);
+    return found >= 0;
+}
+
+/*!
+ @brief Check the structure of an event.
+
+ @details The event header must have the tag `EHDR` and a valid date and time. Then the tags `B#`, `T#` and `C` must be found at the positions given by
+ the boards and channels of the ```TIME``` block (see @ref binary), with the same board serial numbers.
+
+ @param evt The bytes of the event, @ref DAQFile::EvalEventSize() bytes.
+ @return true
+ @return false
+ */
+bool DAQFile::IsValidEvent(const char *evt)
+{
+    auto &eh = *(const EventHeader *)evt;
+    if (memcmp(eh.tag, "EHDR", 4) != 0 or eh.month < 1 or eh.month > 12 or eh.day < 1 or eh.day > 31 or eh.hour > 23 or eh.min > 59 or eh.sec > 59 or eh.ms > 999)
+    {
+        return 0;
+    }
+
+    size_t p = sizeof(EventHeader);
+    int i = 0;
+    for (auto &[bKey, bVal] : times_)
+    {
+        if (evt[p] != 'B' or evt[p + 1] != '#' or *(const unsigned short *)(evt + p + 2) != board_serials_[i])
+        {
+            return 0;
+        }
+        p += 4;
+        if (type_ == "DRS")
+        {
+            if (evt[p] != 'T' or evt[p + 1] != '#')
+            {
+                return 0;
+            }
+            p += 4;
+        }
+        for (size_t j = 0; j < bVal.size(); ++j)
+        {
+            if (evt[p] != 'C')
+            {
+                return 0;
+            }
+            p += 4;
+            if (!is_lab_)
+            {
+                p += 4; // Time scaler
+            }
+            if (type_ == "WDB")
+            {
+                if (evt[p] != 'T' or evt[p + 1] != '#')
+                {
+                    return 0;
+                }
+                p += 4;
+            }
+            p += n_samples_ * sizeof(unsigned short);
+        }
+        ++i;
+    }
+    return 1;
+}
+
+/*!
+ @brief Read into a @ref TAG.
+
+ @param t
+ @return true
+ @return false
+ */
+bool DAQFile::operator>>(TAG &t) // DAQFile >> TAG
+{
+    if (!in_.good())
+    {
+        return 0;
+    }
+    this->Read(t);
+    return *this;
+}
+
+/*!
+ @brief Read into a @ref EventHeader.
+
+ @param eh
+ @return true
+ @return false
+ */
+bool DAQFile::operator>>(EventHeader &eh) // DAQFile >> EventHeader
+{
+    if (!in_.good())
+    {
+        return 0;
+    }
+    this->Read(eh);
+    return *this;
+}
+
+/*!
+ @brief Read into a @ref DRSEvent.
+
+ @details This method reads exactly one event from the file to de DRSEvent class. A first check is made to check if the @ref DAQConfig class has been initialised,
+ otherwise a call to @ref DAQEvent::MakeConfig() is made. The event is read with the reader specialised for the layout of the file (see @ref DAQFile::SetLayout()),
+ that converts the volts and performs the time calibration of each channel. These data are stored in the @ref DAQEvent::times_ and @ref DAQEvent::volts_ maps.
+
+ @param event
+ @return true
+ @return false
+ */
+bool DAQFile::operator>>(DRSEvent &event) // DAQFile >> DRSEvent
+{
+    if (!initialization_) // No layout and no readers without a valid TIME block
+    {
+        return 0;
+    }
+
+    if (!(*this).WaitEvent())
+    {
+        return 0;
+    }
+
+    if (layout_ == Layout::WDB)
+    {
+        cerr << "!! Error: Invalid type of class used" << endl
+             << "Type expected: " << type_ << endl
+             << "Event given: " << event.type_ << endl;
+        exit(0);
+    }
+
+    if (!event.config_.is_makeconfig_)
+    {
+        cout << "Autocall to: DAQEvent::MakeConfig()...";
+        event.MakeConfig(*this);
+        cout << " Done!" << endl;
+    }
+
+    while (trig_pred_ and !(*this).PassTrigger(event))
+    {
+        if (!in_.good() or !(*this).WaitEvent())
+        {
+            return 0;
+        }
+    }
+
+    if (!(this->*read_event_)(event))
+    {
+        return 0;
+    }
+
+    if (event.eh_.serialNumber % 100 == 0)
+    {
+        cout << "Event serial number: " << event.eh_.serialNumber << endl;
+    }
+    return 1;
+}
+
+/*!
+ @brief Read into a @ref WDBEvent.
+
+ @details This method reads exactly one event from the file to de WDBEvent class. A first check is made to check if the @ref DAQConfig class has been initialised,
+ otherwise a call to @ref DAQEvent::MakeConfig() is made. The event is read with the reader specialised for the layout of the file (see @ref DAQFile::SetLayout()),
+ that converts the volts and performs the time calibration of each channel. These data are stored in the @ref DAQEvent::times_ and @ref DAQEvent::volts_ maps.
+
+ @param event
+ @return true
+ @return false
+ */
+bool DAQFile::operator>>(WDBEvent &event) // DAQFile >> WDBEvent
+{
+    if (!initialization_) // No layout and no readers without a valid TIME block
+    {
+        return 0;
+    }
+
+    if (!(*this).WaitEvent())
+    {
+        return 0;
+    }
+
+    if (layout_ != Layout::WDB)
+    {
+        cerr << "!! Error: Invalid type of class used" << endl
+             << "Type expected: " << type_ << endl
+             << "Event given: " << event.type_ << endl;
+        exit(0);
+    }
+
+    if (!event.config_.is_makeconfig_)
+    {
+        cout << "Autocall to: DAQEvent::MakeConfig()...";
+        event.MakeConfig(*this);
+        cout << " Done!" << endl;
+    }
+
+    while (trig_pred_ and !(*this).PassTrigger(event))
+    {
+        if (!in_.good() or !(*this).WaitEvent())
+        {
+            return 0;
+        }
+    }
+
+    if (!(this->*read_event_)(event))
+    {
+        return 0;
+    }
+
+    if (event.eh_.serialNumber % 100 == 0 and event.eh_.serialNumber > 0)
+    {
+        cout << "Event serial number: " << event.eh_.serialNumber << endl;
+    }
+    return 1;
+}
+
+/*!
+ @brief Read into a @ref RawEvent.
+
+ @details This method reads exactly one event without converting the ADC values and without performing the time calibration, see @ref RawEvent.
+ The event is read with the reader specialised for the layout of the file, see @ref DAQFile::SetLayout().
+
+ @param raw
+ @return true
+ @return false
+ */
+bool DAQFile::operator>>(RawEvent &raw) // DAQFile >> RawEvent
+{
+    if (!initialization_) // No layout and no readers without a valid TIME block
+    {
+        return 0;
+    }
+
+    if (!(*this).WaitEvent())
+    {
+        return 0;
+    }
+
+    return (this->*read_raw_)(raw);
+}
+
+/*!
+ @brief Set the readers specialised for the layout of the file.
+
+ @details Called by @ref DAQFile::Initialise(), and in follow mode by @ref DAQFile::WaitEvent() until the first event is written: the number of samples
+ of the waveforms is evaluated (see @ref DAQFile::EvalNSamples()), the layout is chosen from the type of board, and the buffers for one event are allocated.
+
+ @return DAQFile&
+ */
+DAQFile &DAQFile::SetLayout()
+{
+    n_samples_ = (*this).EvalNSamples();
+    if (n_samples_ != SAMPLES_PER_WAVEFORM)
+    {
+        cout << "Waveforms of " << n_samples_ << " samples" << endl;
+    }
+
+    if (type_ == "WDB")
+    {
+        (*this).SetReaders<Layout::WDB>();
+    }
+    else if (is_lab_)
+    {
+        (*this).SetReaders<Layout::LAB>();
+    }
+    else
+    {
+        (*this).SetReaders<Layout::DRS>();
+    }
+
+    adc_.resize(n_samples_);
+    evt_buf_.resize((*this).EvalEventSize());
+    return *this;
+}
+
+/*!
+ @brief Set the readers specialised for a layout and for the number of samples of the waveforms.
+
+ @details The full readout and half of the chip have readers with the number of samples known at compile time, any other length is read by the generic ones.
+
+ @return DAQFile&
+ */
+template <DAQFile::Layout L>
+DAQFile &DAQFile::SetReaders()
+{
+    layout_ = L;
+    switch (n_samples_)
+    {
+    case SAMPLES_PER_WAVEFORM:
+        read_event_ = &DAQFile::ReadEvent<L, SAMPLES_PER_WAVEFORM>;
+        read_raw_ = &DAQFile::ReadRaw<L, SAMPLES_PER_WAVEFORM>;
+        break;
+    case SAMPLES_PER_WAVEFORM / 2:
+        read_event_ = &DAQFile::ReadEvent<L, SAMPLES_PER_WAVEFORM / 2>;
+        read_raw_ = &DAQFile::ReadRaw<L, SAMPLES_PER_WAVEFORM / 2>;
+        break;
+    default:
+        read_event_ = &DAQFile::ReadEvent<L, 0>;
+        read_raw_ = &DAQFile::ReadRaw<L, 0>;
+    }
+    return *this;
+}
+
+/*!
+ @brief Evaluate the number of samples of each waveform from the first event.
+
+ @details With the region of interest readout of the DRS4, or with cascaded channels, the waveforms do not have @ref SAMPLES_PER_WAVEFORM samples, and their number is
+ not written in the file. All the waveforms of a file have the same length, that fixes the size of the events: the second event is searched after the first
+ event header (an `EHDR` followed by the `B#` of the first board), and the number of samples giving that size and a valid first event (see @ref DAQFile::IsValidEvent())
+ is taken. If the file holds a single event its end is used, if no event is written yet @ref SAMPLES_PER_WAVEFORM is assumed and @ref DAQFile::is_nsamples_ is left
+ false: in follow mode the evaluation is then repeated by @ref DAQFile::WaitEvent() once the first event is written. The current position in the file is left untouched.
+
+ @return int
+ */
+int DAQFile::EvalNSamples()
+{
+    auto state = in_.rdstate();
+    in_.clear();
+    long pos = in_.tellg();
+    in_.seekg(0, in_.end);
+    long file_size = in_.tellg();
+
+    // Size of an event without the waveforms
+    is_nsamples_ = false;
+    n_samples_ = 0;
+    evt_size_ = 0;
+    long fixed = (*this).EvalEventSize();
+    evt_size_ = 0;
+    long n_channels = 0;
+    for (auto &[bKey, bVal] : times_)
+    {
+        n_channels += bVal.size();
+    }
+
+    auto valid = [&](const vector<char> &evt, long size)
+    {
+        if (size <= fixed or (size - fixed) % (2 * n_channels) != 0)
+        {
+            return false;
+        }
+        n_samples_ = (size - fixed) / (2 * n_channels);
+        return (*this).IsValidEvent(evt.data());
+    };
+
+    int n_samples = SAMPLES_PER_WAVEFORM;
+    if (n_channels > 0 and file_size - first_evt_pos_ > fixed)
+    {
+        // Up to 8 cascaded channels, and the header of the next event
+        vector<char> evt(min<long>(file_size - first_evt_pos_, fixed + 2 * n_channels * 8 * SAMPLES_PER_WAVEFORM + sizeof(EventHeader) + 4));
+        in_.seekg(first_evt_pos_);
+        in_.read(evt.data(), evt.size());
+
+        long found = -1;
+        const char *end = evt.data() + evt.size() - sizeof(EventHeader) - 4;
+        for (const char *c = evt.data() + fixed; found < 0 and c < end; ++c)
+        {
+            c = (const char *)memchr(c, 'E', end - c);
+            if (c == nullptr)
+            {
+                break;
+            }
+            if (memcmp(c, "EHDR", 4) == 0 and c[sizeof(EventHeader)] == 'B' and c[sizeof(EventHeader) + 1] == '#' and
+                *(const unsigned short *)(c + sizeof(EventHeader) + 2) == board_serials_[0] and valid(evt, c - evt.data()))
+            {
+                found = c - evt.data();
+            }
+        }
+        if (found < 0 and (long)evt.size() == file_size - first_evt_pos_ and valid(evt, evt.size()))
+        {
+            found = evt.size();
+        }
+        if (found > 0)
+        {
+            n_samples = (found - fixed) / (2 * n_channels);
+            is_nsamples_ = true;
+        }
+    }
+
+    in_.clear();
+    in_.seekg(pos);
+    in_.setstate(state);
+    return n_samples;
+}
+
+/*!
+ @brief Read the bytes of one event in @ref DAQFile::evt_buf_.
+
+ @return true
+ @return false The end of file is reached, or the event has an invalid header.
+ */
+bool DAQFile::ReadBlock()
+{
+    in_.read(evt_buf_.data(), evt_buf_.size());
+    if (in_.gcount() != (long)evt_buf_.size())
+    {
+        if (!follow_)
+        {
+            cout << "End of file reached" << endl;
+        }
+        return 0;
+    }
+
+    if (memcmp(evt_buf_.data(), "EHDR", 4) != 0)
+    {
+        cerr << "!! Error: invalid event header in " << filename_ << " --> use DAQFile::SetRecovery()" << endl;
+        in_.setstate(ios::failbit);
+        return 0;
+    }
+    return 1;
+}
+
+/*!
+ @brief Call a function for each channel of the event in @ref DAQFile::evt_buf_.
+
+ @details The number of samples of the waveforms is `N`, or @ref DAQFile::n_samples_ if `N` is 0.
+
+ @param evt The bytes of the event.
+ @param f The function, called with the indices of board and channel, the trigger cell, the time scaler (0 for LAB-DRS) and the ADC values.
+ */
+template <DAQFile::Layout L, int N, typename F>
+void DAQFile::ForEachChannel(const char *evt, F f)
+{
+    using EL = EventLayout<L>;
+    const int channel_size = EL::wf_channel + (N > 0 ? N : n_samples_) * sizeof(unsigned short);
+    const char *p = evt + sizeof(EventHeader);
+    for (auto &[i, bVal] : times_)
+    {
+        unsigned short tCell = 0;
+        if constexpr (!EL::wdb)
+        {
+            tCell = *(const unsigned short *)(p + EL::tcell_board);
+        }
+        p += EL::board_size;
+
+        for (auto &[j, dt] : bVal)
+        {
+            unsigned int scaler = 0;
+            if constexpr (EL::wdb)
+            {
+                tCell = *(const unsigned short *)(p + EL::tcell_channel);
+            }
+            if constexpr (EL::scaler)
+            {
+                memcpy(&scaler, p + EL::scaler_channel, sizeof(unsigned int));
+            }
+            f(i, j, tCell, scaler, (const unsigned short *)(p + EL::wf_channel), dt);
+            p += channel_size;
+        }
+    }
+}
+
+/*!
+ @brief Read one event with the layout given, converting the volts and performing the time calibration.
+
+ @details The waveforms have `N` samples, or @ref DAQFile::n_samples_ if `N` is 0.
+
+ @param event
+ @return true
+ @return false
+ */
+template <DAQFile::Layout L, int N>
+bool DAQFile::ReadEvent(DAQEvent &event)
+{
+    const int n = N > 0 ? N : n_samples_;
+    if (!(*this).ReadBlock())
+    {
+        return 0;
+    }
+
+    memcpy(&event.eh_, evt_buf_.data(), sizeof(EventHeader));
+    event.is_init_ = true;
+    event.routine_ = {false, false, false};
+
+    (*this).ForEachChannel<L, N>(evt_buf_.data(), [&](int i, int j, unsigned short tCell, unsigned int, const unsigned short *adc, const vector<float> &dt)
+                                 {
+        if ((*this).IsTrigger(i, j)) // Already read by DAQFile::PassTrigger()
+        {
+            return;
+        }
+        event.SetVolts(adc, tCell, n, i, j);
+        event.TimeCalibration(tCell, dt, n, i, j); });
+    return 1;
+}
+
+/*!
+ @brief Read one event with the layout given, without converting the ADC values.
+
+ @details The waveforms have `N` samples, or @ref DAQFile::n_samples_ if `N` is 0.
+
+ @param raw
+ @return true
+ @return false
+ */
+template <DAQFile::Layout L, int N>
+bool DAQFile::ReadRaw(RawEvent &raw)
+{
+    const int n = N > 0 ? N : n_samples_;
+    if (!(*this).ReadBlock())
+    {
+        return 0;
+    }
+
+    memcpy(&raw.eh, evt_buf_.data(), sizeof(EventHeader));
+    unsigned int k = 0;
+    (*this).ForEachChannel<L, N>(evt_buf_.data(), [&](int, int, unsigned short tCell, unsigned int scaler, const unsigned short *adc, const vector<float> &)
+                                 {
+        if (raw.adc.size() <= k)
+        {
+            raw.tCell.resize(k + 1);
+            raw.scaler.resize(k + 1);
+            raw.adc.resize(k + 1);
+        }
+        raw.tCell[k] = tCell;
+        raw.scaler[k] = scaler;
+        raw.adc[k].resize(n);
+        memcpy(raw.adc[k].data(), adc, n * sizeof(unsigned short));
+        ++k; });
+
+    raw.tCell.resize(k);
+    raw.scaler.resize(k);
+    raw.adc.resize(k);
+    return 1;
+}
+
+/*!
+ @brief Read a tag.
+
+ @param t
+ */
+void DAQFile::Read(TAG &t)
+{
+    in_.read(t.tag, 4);
+    n_ = t.tag[0];
+    return;
+}
+
+/*!
+ @brief Read an event header.
+
+ @param eh
+ */
+void DAQFile::Read(EventHeader &eh)
+{
+    in_.read((char *)&eh, sizeof(eh));
+    n_ = eh.tag[0];
+}
+
+/*!
+ @brief Read a vector of float.
+
+ @param vec
+ */
+void DAQFile::Read(vector<float> &vec)
+{
+    in_.read((char *)vec.data(), vec.size() * sizeof(float));
+    return;
+}
+
+/*!
+ @brief Read the ADC values of a waveform.
+
+ @details The values are read with a single call, the conversion to Volts is done by @ref DAQEvent::SetVolts().
+
+ @param vec
+ */
+void DAQFile::Read(vector<unsigned short> &vec)
+{
+    vec.resize(n_samples_);
+    in_.read((char *)vec.data(), vec.size() * sizeof(unsigned short));
+    return;
+}
+
+/*!
+ @brief The evaluation of boolean for the class DAQFile.
+
+ @details This method evaluates all the valid possible combinations of consecutive tags to determine if the value to return is 1 or 0.
+ It uses the same principle of a finite state machine with the usage of a map named **header**, where the combinations of key-value match the
+ possible configurations of consecutive non-equal tags that can be found in the binary file.
+
+ @return true
+ @return false
+ */
+DAQFile::operator bool()
+{
+    auto header = [](char c) // E --> B, B --> C, C --> B
+    { return c == 'E' ? 'B' : (c == 'B' ? 'C' : (c == 'C' ? 'B' : '\0')); };
+    if (!in_.good())
+    {
+        if (!follow_)
+        {
+            cout << "End of file reached" << endl;
+        }
+        return 0;
+    }
+    else if (n_ == 'T' or n_ == 'D') // Ignores DRSx and TIME
+        return 0;
+    else if (n_ == o_) // C --> C, B --> B
+        return 1;
+    else if (n_ == header(o_)) // E --> B, B --> C, C --> B
+    {
+        o_ = n_;
+        return 1;
+    }
+    else if (n_ == 'E' and initialization_ == 0) // End of initialization, first EHDR
+    {
+        cout << "Initialization done --> EHDR next" << endl;
+        initialization_ = 1;
+        return 0;
+    }
+    return 0;
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : DAQCalibration                                                │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+static const char CALIBRATION_MAGIC[4] = {'R', 'W', 'D', 'C'}; ///< First word of the registry file.
+
+/*!
+ @brief Parse the bytes of a ```TIME``` block.
+
+ @param raw The bytes, from the first `B#` to the first `EHDR` excluded.
+ @param times The map of \f$ \Delta t\f$ to be filled.
+ @param serials The serial numbers of the boards to be filled.
+ */
+static void ParseTimes(const vector<char> &raw, map<int, map<int, vector<float>>> &times, vector<unsigned short> &serials)
+{
+    size_t pos = 0;
+    int i = -1, j = 0;
+    while (pos + 4 <= raw.size())
+    {
+        const char *tag = raw.data() + pos;
+        if (tag[0] == 'B' and tag[1] == '#')
+        {
+            serials.push_back(*(unsigned short *)(tag + 2));
+            ++i;
+            j = 0;
+            pos += 4;
+        }
+        else if (tag[0] == 'C' and i >= 0 and pos + 4 + SAMPLES_PER_WAVEFORM * sizeof(float) <= raw.size())
+        {
+            auto &vec = times[i][j];
+            vec.resize(SAMPLES_PER_WAVEFORM);
+            memcpy(vec.data(), tag + 4, SAMPLES_PER_WAVEFORM * sizeof(float));
+            pos += 4 + SAMPLES_PER_WAVEFORM * sizeof(float);
+            ++j;
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+/*!
+ @brief Get the process-wide registry.
+
+ @return DAQCalibration&
+ */
+DAQCalibration &DAQCalibration::Registry()
+{
+    static DAQCalibration registry;
+    return registry;
+}
+
+/*!
+ @brief Read the registered blocks from a file and add them to the registry.
+
+ @param fname The name of the file written by @ref DAQCalibration::Save().
+ @return DAQCalibration&
+ */
+DAQCalibration &DAQCalibration::Load(const string &fname)
+{
+    ifstream in(fname, std::ios::in | std::ios::binary);
+    if (!in.is_open())
+    {
+        cerr << "Warning: calibration registry " << fname << " not found" << endl;
+        return *this;
+    }
+
+    char magic[4];
+    unsigned int n_entries = 0;
+    in.read(magic, 4);
+    in.read((char *)&n_entries, sizeof(unsigned int));
+    if (!in.good() or memcmp(magic, CALIBRATION_MAGIC, 4) != 0)
+    {
+        cerr << "!! Error: invalid calibration registry " << fname << endl;
+        return *this;
+    }
+
+    for (unsigned int k = 0; k < n_entries; ++k)
+    {
+        Entry entry;
+        unsigned long long size;
+        in.read((char *)&entry.serial, sizeof(unsigned short));
+        in.read((char *)&entry.hash, sizeof(unsigned long long));
+        in.read((char *)&size, sizeof(unsigned long long));
+        entry.raw.resize(size);
+        in.read(entry.raw.data(), size);
+        if (!in.good() or HashFNV(entry.raw.data(), size) != entry.hash)
+        {
+            cerr << "!! Error: calibration registry " << fname << " is corrupted" << endl;
+            break;
+        }
+        ParseTimes(entry.raw, entry.times, entry.serials);
+        (*this).Add(entry);
+    }
+
+    return *this;
+}
+
+/*!
+ @brief Write the registered blocks to a file.
+
+ @param fname The name of the file.
+ @return DAQCalibration&
+ */
+DAQCalibration &DAQCalibration::Save(const string &fname)
+{
+    lock_guard<mutex> lock(mutex_);
+
+    ofstream o(fname, std::ios::out | std::ios::binary);
+    if (!o.is_open())
+    {
+        cerr << "!! Error: unable to write calibration registry " << fname << endl;
+        return *this;
+    }
+
+    unsigned int n_entries = entries_.size();
+    o.write(CALIBRATION_MAGIC, 4);
+    o.write((char *)&n_entries, sizeof(unsigned int));
+    for (auto &entry : entries_)
+    {
+        unsigned long long size = entry.raw.size();
+        o.write((char *)&entry.serial, sizeof(unsigned short));
+        o.write((char *)&entry.hash, sizeof(unsigned long long));
+        o.write((char *)&size, sizeof(unsigned long long));
+        o.write(entry.raw.data(), size);
+    }
+    return *this;
+}
+
+/*!
+ @brief Remove all the registered blocks.
+
+ @return DAQCalibration&
+ */
+DAQCalibration &DAQCalibration::Clear()
+{
+    lock_guard<mutex> lock(mutex_);
+    entries_.clear();
+    return *this;
+}
+
+/*!
+ @brief Get the number of registered blocks.
+
+ @return size_t
+ */
+size_t DAQCalibration::GetSize()
+{
+    lock_guard<mutex> lock(mutex_);
+    return entries_.size();
+}
+
+/*!
+ @brief Look for the ```TIME``` block at the current position of the stream in the registry.
+
+ @details For each registered block with the same serial number of the first board, the same number of bytes is read from the stream (with a single
+ read), then hash and bytes are compared. The block must be followed by an `EHDR` tag. If a block matches, the calibration is copied and the stream is left
+ at the first event header, otherwise the stream is left untouched.
+
+ @param in The stream, at the first `B#` tag of the ```TIME``` block.
+ @param times The map of \f$ \Delta t\f$ to be filled.
+ @param serials The serial numbers of the boards to be filled.
+ @return true
+ @return false
+ */
+bool DAQCalibration::Reuse(ifstream &in, MAP &times, vector<unsigned short> &serials)
+{
+    lock_guard<mutex> lock(mutex_);
+    if (entries_.empty())
+    {
+        return 0;
+    }
+
+    auto start = in.tellg();
+    TAG tag;
+    in.read(tag.tag, 4);
+    auto serial = *(unsigned short *)(tag.tag + 2);
+
+    vector<char> raw;
+    for (auto &entry : entries_)
+    {
+        if (entry.serial != serial)
+        {
+            continue;
+        }
+
+        in.clear();
+        in.seekg(start);
+        raw.resize(entry.raw.size() + 4);
+        in.read(raw.data(), raw.size());
+        if (!in.good() or memcmp(raw.data() + entry.raw.size(), "EHDR", 4) != 0)
+        {
+            continue;
+        }
+        if (HashFNV(raw.data(), entry.raw.size()) != entry.hash or memcmp(raw.data(), entry.raw.data(), entry.raw.size()) != 0)
+        {
+            continue;
+        }
+
+        times = entry.times;
+        serials = entry.serials;
+        in.seekg(start + (streamoff)entry.raw.size());
+        return 1;
+    }
+
+    in.clear();
+    in.seekg(start);
+    return 0;
+}
+
+/*!
+ @brief Add the ```TIME``` block of a stream to the registry.
+
+ @param in The stream, its position is restored.
+ @param start Position of the first `B#` tag of the block.
+ @param stop Position of the first `EHDR` tag.
+ */
+void DAQCalibration::Add(ifstream &in, streampos start, streampos stop)
+{
+    Entry entry;
+    auto pos = in.tellg();
+    entry.raw.resize(stop - start);
+    in.seekg(start);
+    in.read(entry.raw.data(), entry.raw.size());
+    in.seekg(pos);
+    if (entry.raw.size() < 4)
+    {
+        return;
+    }
+
+    entry.hash = HashFNV(entry.raw.data(), entry.raw.size());
+    ParseTimes(entry.raw, entry.times, entry.serials);
+    entry.serial = entry.serials.empty() ? 0 : entry.serials[0];
+    (*this).Add(entry);
+}
+
+/*!
+ @brief Add a block to the registry, if not already registered.
+
+ @param entry The block.
+ */
+void DAQCalibration::Add(Entry &entry)
+{
+    lock_guard<mutex> lock(mutex_);
+    for (auto &e : entries_)
+    {
+        if (e.serial == entry.serial and e.hash == entry.hash and e.raw == entry.raw)
+        {
+            return;
+        }
+    }
+    entries_.push_back(move(entry));
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : ChannelIndex                                                  │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new ChannelIndex object.
+
+ @param times The map of \f$ \Delta t\f$ of the ```TIME``` block, only the boards and channels are used.
+ */
+ChannelIndex::ChannelIndex(const MAP &times)
+{
+    n_channels_ = 0;
+    for (auto &[bKey, bVal] : times)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            index_[bKey][cKey] = n_channels_++;
+        }
+    }
+}
+
+/*!
+ @brief Get the index of a channel.
+
+ @param b The board.
+ @param c The channel.
+ @return int
+ */
+int ChannelIndex::Index(int b, int c) const
+{
+    auto board = index_.find(b);
+    if (board != index_.end())
+    {
+        auto channel = board->second.find(c);
+        if (channel != board->second.end())
+        {
+            return channel->second;
+        }
+    }
+    cerr << "!! Error : Couldn't find board-channel of ID (" << b << ", " << c << ")" << endl;
+    exit(0);
+}
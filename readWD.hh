@@ -21,8 +21,14 @@
 #include <algorithm>
 #include <math.h>
 #include <cstring>
+#include <mutex>
+#include <functional>
 
-#define SAMPLES_PER_WAVEFORM 1024 ///< The number of samples made by the waveforms, both DRS and WDB.
+#include "readWDFilter.hh"
+#include "readWDOffset.hh"
+
+#define SAMPLES_PER_WAVEFORM 1024 ///< The number of cells of the chip: the \f$ \Delta t\f$ of each channel in the ```TIME``` block and the samples of a full readout.
+#define RESYNC_BLOCK (1 << 20)    ///< The size in bytes of the blocks searched by @ref DAQFile::Resync().
 
 /*
   ┌─────────────────────────────────────────────────────────────────────────┐
@@ -66,9 +72,61 @@ struct EventHeader
     unsigned short rangeCenter; ///< The rangeCenter (in Volts).
 };
 
+/*!
+ @brief Summary of a waveform, evaluated while the ADC values are converted to Volts.
+
+ @details It is stored for each channel by @ref DAQEvent and used by the analysis methods, see @ref DAQEvent::GetStats().
+ */
+struct WaveformStats
+{
+    float min;   ///< The minimum voltage.
+    float max;   ///< The maximum voltage.
+    int argmin;  ///< The index of the first minimum.
+    int argmax;  ///< The index of the first maximum.
+    double sum;  ///< The sum of the voltages.
+    double sum2; ///< The sum of the squared voltages.
+};
+
+/*!
+ @brief Raw content of one event, as stored in the file.
+
+ @details The channels are stored in the same order in which they are found in the file (board by board), the ADC values are not converted to Volts
+ and the time calibration is not performed. For DRS boards the trigger cell of the board is copied for each of its channels.
+ */
+struct RawEvent
+{
+    EventHeader eh;                                ///< The event header.
+    std::vector<unsigned short> tCell;             ///< The trigger cell of each channel.
+    std::vector<unsigned int> scaler;              ///< The time scaler of each channel, 0 for LAB-DRS.
+    std::vector<std::vector<unsigned short>> adc;  ///< The ADC values of each channel.
+};
+
+/*!
+ @brief Summary of a file, as evaluated by @ref DAQFile::Scan().
+
+ @details Only the event headers and the tags of the first event are read, the waveforms are never decoded.
+ */
+struct DAQSummary
+{
+    std::string filename;                                      ///< The name of the file.
+    std::string type;                                          ///< The type of board, "DRS" or "WDB".
+    bool is_lab;                                               ///< Flag to check if the board is from LAB or not.
+    long n_events;                                             ///< The number of complete events with a valid header.
+    bool truncated;                                            ///< True if the file ends with a partial event or an invalid header was found.
+    EventHeader first;                                         ///< The header of the first event.
+    EventHeader last;                                          ///< The header of the last event.
+    double time_span;                                          ///< Time between the first and the last event, in seconds.
+    double rate;                                               ///< Mean event rate, in Hz.
+    std::vector<unsigned short> board_serials;                 ///< The serial numbers of the boards.
+    std::map<int, std::vector<int>> channels;                  ///< The channel numbers (as written in the ```C``` tags) of each board.
+    int n_samples;                                             ///< The number of samples of each waveform, see @ref DAQFile::GetNSamples().
+    std::vector<std::pair<unsigned int, unsigned int>> gaps;   ///< The serial numbers before and after each jump in the numbering.
+};
+
 class DAQConfig;
 class DAQEvent;
 class DAQFile;
+class DAQArchive;
 
 /*!
  @brief Main class to hold various settings for the channels.
@@ -83,12 +141,15 @@ private:
     DAQConfig();
 
     void MakeConfig(DAQFile &);
+    void MakeConfig(const std::map<int, std::map<int, std::vector<float>>> &, int = SAMPLES_PER_WAVEFORM);
     void ShowConfig();
 
     std::map<int, std::map<int, std::pair<int, int>>> intWindow_;   ///< Data member to hold integration windows intervals of various channels.
     std::map<int, std::map<int, std::pair<int, int>>> pedInterval_; ///< Data member to hold pedestal intervals of various channels.
     std::map<int, std::map<int, float>> peakThr_;                   ///< Data member to hold peak threshold values of various channels.
     std::map<int, std::map<int, bool>> user_iw_;                    ///< Data member to hold which integration windows were set by the user.
+    std::map<int, std::map<int, WaveformFilter>> filter_;           ///< Data member to hold the filters applied to the waveforms of various channels.
+    std::map<int, std::map<int, std::vector<float>>> offset_;       ///< Data member to hold the offsets of the cells of various channels, repeated for the number of samples after the last cell.
 
     void SetIntWindow(std::pair<int, int>, int, int);
     void SetIntWindow(std::pair<int, int>);
@@ -96,11 +157,20 @@ private:
     void SetPedInterval(std::pair<int, int>);
     void SetPeakThr(float, int, int);
     void SetPeakThr(float);
+    void SetFilter(const WaveformFilter &, int, int);
+    void SetFilter(const WaveformFilter &);
+    void SetOffsetCalibration(const OffsetCalibration &, int, int);
+    void SetOffsetCalibration(const OffsetCalibration &);
 
     bool is_makeconfig_; ///< Flag to check if the method @ref DAQConfig::MakeConfig() has been called at least once.
+    int n_samples_;      ///< The number of samples of the waveforms, the upper bound of the intervals.
+    bool is_filter_;     ///< Flag to check if a filter has been set on any channel.
+    bool is_offset_;     ///< Flag to check if the offsets of the cells have been set on any channel.
 
     friend class DAQEvent;
     friend class DAQFile;
+    friend class DAQArchive;
+    friend class DAQFeatureCache;
 };
 
 /*!
@@ -119,6 +189,8 @@ public:
     void SetPeakThr(float);
     void SetIntWindow(int, int);
     void SetIntWindow(float, float);
+    void SetFilter(const WaveformFilter &);
+    void SetOffsetCalibration(const OffsetCalibration &);
 
     /*!
      @brief Method to simply call @ref DAQConfig::MakeConfig().
@@ -126,6 +198,8 @@ public:
      @param file The file to be read.
      */
     void MakeConfig(DAQFile &file) { config_.MakeConfig(file); };
+    void MakeConfig(DAQArchive &);
+    DAQEvent &Reserve(DAQFile &);
     /*!
      @brief Simple method to call @ref DAQConfig::ShowConfig().
 
@@ -141,6 +215,8 @@ public:
     const std::pair<float, float> &GetPedestal();
     const std::vector<float> &GetVolts();
     const std::vector<float> &GetTimes();
+    const WaveformStats &GetStats();
+    unsigned short GetTriggerCell();
     const std::vector<int> &GetPeakIndices();
     const std::pair<int, int> &GetIntegrationBounds();
     const EventHeader &GetEH() { return eh_; };
@@ -151,13 +227,17 @@ public:
 protected:
     DAQEvent();
 
-    DAQEvent &TimeCalibration(const unsigned short &, const std::vector<float> &, int, int);
+    DAQEvent &TimeCalibration(const unsigned short &, const std::vector<float> &, int, int, int);
+    DAQEvent &SetVolts(const unsigned short *, unsigned short, int, int, int);
     DAQEvent &EvalPedestal();
     DAQEvent &EvalIntegrationBounds();
     DAQEvent &FindPeaks();
+    long GlobalMin();
 
     MAP times_; ///< Structure to hold integrated times values of all boards and channels.
     MAP volts_; ///< Structure to hold voltage values of all boards and channels.
+    std::map<int, std::map<int, WaveformStats>> stats_; ///< Structure to hold the summary of the waveforms of all boards and channels.
+    std::map<int, std::map<int, unsigned short>> tcell_; ///< Structure to hold the trigger cells of all boards and channels.
 
     EventHeader eh_;
     DAQConfig config_; ///< Class to hold settings about pedestal and integration window intervals.
@@ -168,6 +248,7 @@ protected:
     std::pair<int, int> iw_;           ///< Pair to hold indices as boundary edges where integration is performed by @ref DAQEvent::GetCharge().
     std::pair<int, int> ch_;           ///< Pair to hold indices of board and channel selected;
     std::vector<int> indexMin_;        ///< Indices of local minima found.
+    std::vector<float> filter_buf_;    ///< Buffer used by the filters, see @ref DAQEvent::SetFilter().
 
     bool is_init_;         ///< Flag to check if the file is initialised
     bool is_getch_;        ///< Flag to check if the method @ref DAQEvent::GetChannel() has been called
@@ -182,6 +263,8 @@ protected:
                                  ///< @ref DAQEvent::FindPeaks() and @ref DAQEvent::EvalIntegrationBounds()
 
     friend class DAQFile;
+    friend class DAQArchive;
+    friend class DAQFeatureCache;
 };
 
 /*!
@@ -224,14 +307,78 @@ public:
     DAQFile &Reset();
 
     DAQFile &GetEvent(int);
+    DAQFile &SetFollow(bool, int = 500, int = -1);
+    DAQFile &SetRecovery(bool);
+    DAQFile &SelectSerials(unsigned int, unsigned int);
+    DAQFile &SelectTime(const std::string &, const std::string &);
+    DAQFile &SelectEvents(const std::vector<unsigned int> &);
+    DAQFile &ClearSelection();
+    long GetNSelected();
+    DAQFile &SetTrigger(int, int, const std::function<bool(DAQEvent &)> &);
+    long GetNEvents();
+    int GetNSamples() { return n_samples_; };
+    DAQSummary Scan();
 
     bool operator>>(DRSEvent &);
     bool operator>>(WDBEvent &);
+    bool operator>>(RawEvent &);
 
     const MAP &GetTimeMap() { return times_; };
+    const std::string &GetType() { return type_; };
+    const std::string &GetFileName() { return filename_; };
+    const std::vector<unsigned short> &GetBoardSerials() { return board_serials_; };
+    const std::vector<std::pair<long, long>> &GetSkipped() { return skipped_; };
 
 private:
+    /*!
+     @brief The layouts of the events, see @ref binary.
+     */
+    enum class Layout
+    {
+        DRS, ///< DRS evaluation board: `B#`, `T#`, then `C`, time scaler and waveform for each channel.
+        LAB, ///< LAB-DRS board: as DRS, without the time scaler.
+        WDB  ///< WaveDREAM board: `B#`, then `C`, time scaler, `T#` and waveform for each channel.
+    };
+
+    /*!
+     @brief Offsets of the fields of an event, for each layout.
+
+     @details The offsets are known at compile time, so that the specialised readers do not branch on the type of board.
+     */
+    template <Layout L>
+    struct EventLayout
+    {
+        static constexpr bool wdb = L == Layout::WDB;                                                    ///< `T#` is in the channel, not in the board
+        static constexpr bool scaler = L != Layout::LAB;                                                 ///< The channel has a time scaler
+        static constexpr int board_size = wdb ? 4 : 8;                                                   ///< `B#`, then `T#` if not WDB
+        static constexpr int tcell_board = 6;                                                            ///< Trigger cell from the beginning of the board, if not WDB
+        static constexpr int tcell_channel = 10;                                                         ///< Trigger cell from the beginning of the channel, if WDB
+        static constexpr int scaler_channel = 4;                                                         ///< Time scaler from the beginning of the channel
+        static constexpr int wf_channel = 4 + (scaler ? 4 : 0) + (wdb ? 4 : 0);                          ///< Waveform from the beginning of the channel
+    };
+
     DAQFile &Initialise();
+    DAQFile &SetLayout();
+    template <Layout L>
+    DAQFile &SetReaders();
+    template <Layout L, int N>
+    bool ReadEvent(DAQEvent &);
+    template <Layout L, int N>
+    bool ReadRaw(RawEvent &);
+    template <Layout L, int N, typename F>
+    void ForEachChannel(const char *, F);
+    bool ReadBlock();
+    int EvalEventSize();
+    int EvalNSamples();
+    bool WaitEvent();
+    bool Resync(long);
+    bool IsValidEvent(const char *);
+    bool NextSelected();
+    template <typename F>
+    long FindEvent(F);
+    DAQFile &AddSelection(long, long);
+    bool PassTrigger(DAQEvent &);
+    bool IsTrigger(int i, int j) { return trig_pred_ and i == trig_ch_.first and j == trig_ch_.second; }
 
     bool operator>>(TAG &);
     bool operator>>(EventHeader &);
@@ -239,7 +386,7 @@ private:
     void Read(TAG &);
     void Read(EventHeader &);
     void Read(std::vector<float> &);
-    void Read(std::vector<float> &, const unsigned short &);
+    void Read(std::vector<unsigned short> &);
     void ResetTag() { in_.seekg(-4, in_.cur); }
 
     std::string filename_; ///< The name of the file
@@ -251,8 +398,120 @@ private:
     bool is_lab_;          ///< Flag to check if the board is from LAB or not
     std::string type_;     ///< Flag to store the type of the board
     int first_evt_pos_;    ///< Position of first event header
+    int evt_size_;         ///< Size in bytes of one event, evaluated by @ref DAQFile::EvalEventSize()
+    int n_samples_;        ///< Number of samples of each waveform, evaluated by @ref DAQFile::EvalNSamples()
+    bool is_nsamples_;     ///< Flag to check if the number of samples was measured from the events of the file, see @ref DAQFile::EvalNSamples()
+    std::vector<unsigned short> board_serials_; ///< Serial numbers of the boards found in the ```TIME``` block
+    bool follow_;          ///< Flag to check if the file is read in follow mode, see @ref DAQFile::SetFollow()
+    long follow_pos_;      ///< Position of the next event in follow mode
+    int poll_ms_;          ///< Time between two checks of the file size in follow mode
+    int timeout_ms_;       ///< Time without new events after which the follow mode stops
+    std::vector<unsigned short> adc_; ///< Buffer for the ADC values of one waveform
+    std::vector<char> resync_buf_; ///< Buffer for the event checked by @ref DAQFile::Resync()
+    std::vector<char> evt_buf_; ///< Buffer for the bytes of one event
+    Layout layout_;        ///< The layout of the events, set by @ref DAQFile::SetLayout()
+    bool (DAQFile::*read_event_)(DAQEvent &); ///< The reader specialised for the layout of the file
+    bool (DAQFile::*read_raw_)(RawEvent &);   ///< The raw reader specialised for the layout of the file
+    bool recovery_;        ///< Flag to check if the file is read in recovery mode, see @ref DAQFile::SetRecovery()
+    std::vector<std::pair<long, long>> skipped_; ///< Position and size in bytes of the corrupted regions skipped in recovery mode
+    bool select_;          ///< Flag to check if only the selected events are read, see @ref DAQFile::SelectSerials()
+    std::vector<std::pair<long, long>> selection_; ///< Sorted ranges [first, last) of the numbers of the selected events, starting from 0
+    size_t sel_range_;     ///< Index of the range of the next selected event
+    long sel_next_;        ///< Number of the next selected event
+    std::function<bool(DAQEvent &)> trig_pred_; ///< The condition on the trigger channel, see @ref DAQFile::SetTrigger()
+    std::pair<int, int> trig_ch_; ///< Board and channel indices of the trigger channel
+    long trig_tcell_pos_;  ///< Position of the trigger cell of the trigger channel, from the beginning of the event
+    long trig_wf_pos_;     ///< Position of the waveform of the trigger channel, from the beginning of the event
 
     friend class DAQConfig;
+    friend class DAQDataSource;
+    friend class DAQArchive;
+};
+
+/*!
+ @brief Process-wide registry of the ```TIME``` blocks already read.
+
+ @details Consecutive files coming from the same boards usually carry the same ```TIME``` block. When a file is initialised, @ref DAQFile::Initialise()
+ looks in the registry for a block with the serial number of the first board: the bytes of the file are read with a single call, hashed and compared with the
+ registered block, and if they match the parsed calibration is reused instead of being parsed again. Otherwise the block is parsed and added to the registry.
+
+ The registry can be written to and read from disk, so that the calibrations are shared also between different jobs:
+ @code{.cpp}
+ DAQCalibration::Registry().Load("calibrations.rwdc");
+ // ... open the files ...
+ DAQCalibration::Registry().Save("calibrations.rwdc");
+ @endcode
+ */
+class DAQCalibration
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+
+public:
+    static DAQCalibration &Registry();
+
+    DAQCalibration &Load(const std::string &);
+    DAQCalibration &Save(const std::string &);
+    DAQCalibration &Clear();
+    size_t GetSize();
+
+private:
+    DAQCalibration() {}
+
+    /*!
+     @brief A registered ```TIME``` block.
+     */
+    struct Entry
+    {
+        unsigned short serial;              ///< Serial number of the first board.
+        unsigned long long hash;            ///< Hash of the bytes of the block.
+        std::vector<char> raw;              ///< The bytes of the block, from the first `B#` to the first `EHDR` excluded.
+        MAP times;                          ///< The parsed \f$ \Delta t\f$.
+        std::vector<unsigned short> serials; ///< Serial numbers of all the boards.
+    };
+
+    bool Reuse(std::ifstream &, MAP &, std::vector<unsigned short> &);
+    void Add(std::ifstream &, std::streampos, std::streampos);
+    void Add(Entry &);
+
+    std::vector<Entry> entries_; ///< The registered blocks.
+    std::mutex mutex_;           ///< Mutex to use the registry from many threads.
+
+    friend class DAQFile;
+};
+
+/*!
+ @brief Index of the boards and channels of a file in the buffers of an analysis class.
+
+ @details The channels of the ```TIME``` block are numbered in the order of the map, from 0, so that an analysis class can keep one entry per channel
+ in flat vectors, filled in the same order. A channel not in the file is an error.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ ChannelIndex channels(file.GetTimeMap());
+ std::vector<float> results(channels.GetNChannels());
+
+ results[channels.Index(0, 1)] = 1; // Board 0, channel 1
+ @endcode
+ */
+class ChannelIndex
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+    using INDEX = std::map<int, std::map<int, int>>;               ///< Alias for the index of each board and channel.
+
+public:
+    ChannelIndex(const MAP &);
+
+    int Index(int, int) const;
+    int GetNChannels() const { return n_channels_; };
+
+    INDEX::const_iterator begin() const { return index_.begin(); };
+    INDEX::const_iterator end() const { return index_.end(); };
+    bool operator==(const ChannelIndex &other) const { return index_ == other.index_; };
+    bool operator!=(const ChannelIndex &other) const { return index_ != other.index_; };
+
+private:
+    INDEX index_;    ///< Index of each board and channel
+    int n_channels_; ///< Number of channels
 };
 
 /*
@@ -263,5 +522,7 @@ private:
 
 std::ostream &operator<<(std::ostream &, const TAG &);
 std::ostream &operator<<(std::ostream &, const EventHeader &);
+std::ostream &operator<<(std::ostream &, const DAQSummary &);
+unsigned long long HashFNV(const void *, size_t, unsigned long long = 14695981039346656037ULL);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,684 @@
+/*!
+ @file readWDArchive.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the readWD native archive format.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDArchive.hh"
+
+using namespace std;
+
+static const char ARCHIVE_MAGIC[4] = {'R', 'W', 'D', 'A'}; ///< First word of the archive.
+static const char INDEX_MAGIC[4] = {'R', 'W', 'D', 'I'};   ///< Last word of the archive.
+static const unsigned int ARCHIVE_VERSION = 2;             ///< Version of the archive layout, 2 adds the number of samples of the waveforms.
+static const unsigned int ENCODING_RAW = 0;                ///< Channel block with raw ADC values.
+static const unsigned int ENCODING_CODEC = 1;              ///< Channel block encoded with @ref WaveformCodec.
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : DAQEvent                                                      │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Method to call @ref DAQConfig::MakeConfig() with the boards and channels of an archive.
+
+ @param archive The archive to be read.
+ */
+void DAQEvent::MakeConfig(DAQArchive &archive)
+{
+    config_.MakeConfig(archive.GetTimeMap(), archive.GetNSamples());
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : DAQArchive                                                    │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new DAQArchive::DAQArchive object
+
+ */
+DAQArchive::DAQArchive()
+{
+    std::cout << "Created DAQArchive, open a file using DAQArchive::Open()" << endl;
+    initialization_ = 0;
+    is_lab_ = 0;
+    chunk_size_ = 0;
+    n_samples_ = SAMPLES_PER_WAVEFORM;
+    n_events_ = 0;
+    cursor_ = 0;
+    chunk_loaded_ = -1;
+}
+
+/*!
+ @brief Construct a new DAQArchive::DAQArchive object.
+
+ @param fname The file name to be opened.
+ */
+DAQArchive::DAQArchive(const string &fname)
+{
+    initialization_ = 0;
+    is_lab_ = 0;
+    chunk_size_ = 0;
+    n_samples_ = SAMPLES_PER_WAVEFORM;
+    n_events_ = 0;
+    cursor_ = 0;
+    chunk_loaded_ = -1;
+    (*this).Open(fname);
+}
+
+/*!
+ @brief Convert a DRS/WDB binary file into an archive.
+
+ @details The binary file is read with @ref DAQFile::operator>>(RawEvent &), the ADC values are stored without conversion so that the
+ archive is lossless. The layout of the archive is described in @ref archive.
+
+ @param in The DRS/WDB binary file.
+ @param out The archive to be written.
+ @param chunk_size The number of events in each chunk.
+ @param compress If true the waveforms are encoded with @ref WaveformCodec, otherwise the raw ADC values are stored.
+ @return true
+ @return false
+ */
+bool DAQArchive::Convert(const string &in, const string &out, unsigned int chunk_size, bool compress)
+{
+    if (chunk_size == 0)
+    {
+        cerr << "!! Error: chunk size must be a positive integer" << endl;
+        return 0;
+    }
+
+    DAQFile file(in);
+    if (file.type_.empty())
+    {
+        cerr << "!! Error: unable to initialise file " << in << endl;
+        return 0;
+    }
+
+    ofstream o(out, std::ios::out | std::ios::binary);
+    if (!o.is_open())
+    {
+        cerr << "!! Error: unable to open file " << out << endl;
+        return 0;
+    }
+    cout << "Converting " << in << " --> " << out << endl;
+
+    // File header
+    char type[4] = {0, 0, 0, 0};
+    unsigned int is_lab = file.is_lab_;
+    unsigned int n_boards = file.times_.size();
+    unsigned int n_samples = file.n_samples_;
+    memcpy(type, file.type_.data(), min<size_t>(file.type_.size(), 4));
+    o.write(ARCHIVE_MAGIC, 4);
+    o.write((char *)&ARCHIVE_VERSION, sizeof(unsigned int));
+    o.write(type, 4);
+    o.write((char *)&is_lab, sizeof(unsigned int));
+    o.write((char *)&n_boards, sizeof(unsigned int));
+    o.write((char *)&n_samples, sizeof(unsigned int));
+
+    unsigned int n_channels = 0;
+    for (auto &[bKey, bVal] : file.times_)
+    {
+        unsigned short serial = bKey < (int)file.board_serials_.size() ? file.board_serials_[bKey] : 0;
+        unsigned int n_ch = bVal.size();
+        o.write((char *)&serial, sizeof(unsigned short));
+        o.write((char *)&n_ch, sizeof(unsigned int));
+        for (auto &[cKey, cVal] : bVal)
+        {
+            o.write((char *)cVal.data(), cVal.size() * sizeof(float));
+        }
+        n_channels += n_ch;
+    }
+    o.write((char *)&chunk_size, sizeof(unsigned int));
+
+    // Chunks
+    Buffer buffer;
+    buffer.tCell.resize(n_channels);
+    buffer.scaler.resize(n_channels);
+    buffer.adc.resize(n_channels);
+
+    vector<Chunk> index;
+    unsigned long long n_events = 0;
+    RawEvent raw;
+    while (file >> raw)
+    {
+        if (raw.adc.size() != n_channels)
+        {
+            cerr << "!! Error: event " << raw.eh.serialNumber << " has " << raw.adc.size() << " channels, expected " << n_channels << endl;
+            return 0;
+        }
+
+        buffer.eh.push_back(raw.eh);
+        for (unsigned int k = 0; k < n_channels; ++k)
+        {
+            buffer.tCell[k].push_back(raw.tCell[k]);
+            buffer.scaler[k].push_back(raw.scaler[k]);
+            buffer.adc[k].insert(buffer.adc[k].end(), raw.adc[k].begin(), raw.adc[k].end());
+        }
+        ++n_events;
+
+        if (buffer.eh.size() == chunk_size)
+        {
+            WriteChunk(o, buffer, index, n_events - chunk_size, n_samples, compress);
+        }
+    }
+    if (buffer.eh.size() > 0)
+    {
+        WriteChunk(o, buffer, index, n_events - buffer.eh.size(), n_samples, compress);
+    }
+
+    // Index
+    unsigned long long index_pos = o.tellp();
+    unsigned int n_chunks = index.size();
+    o.write((char *)&n_events, sizeof(unsigned long long));
+    o.write((char *)&n_chunks, sizeof(unsigned int));
+    for (auto &chunk : index)
+    {
+        o.write((char *)&chunk.offset, sizeof(unsigned long long));
+        o.write((char *)&chunk.first, sizeof(unsigned long long));
+        o.write((char *)&chunk.n_events, sizeof(unsigned int));
+        for (unsigned int k = 0; k < n_channels; ++k)
+        {
+            o.write((char *)&chunk.ch_offset[k], sizeof(unsigned long long));
+            o.write((char *)&chunk.ch_size[k], sizeof(unsigned int));
+            o.write((char *)&chunk.ch_encoding[k], sizeof(unsigned int));
+        }
+    }
+    o.write((char *)&index_pos, sizeof(unsigned long long));
+    o.write(INDEX_MAGIC, 4);
+
+    cout << "Converted " << n_events << " events in " << n_chunks << " chunks" << endl;
+    return o.good();
+}
+
+/*!
+ @brief Write a chunk and add it to the index.
+
+ @details The event headers, the trigger cells and the time scalers are written first, then a block for each channel with the ADC values of all the
+ events of the chunk. The buffer is emptied.
+
+ @param o The archive.
+ @param buffer The events of the chunk.
+ @param index The index to be updated.
+ @param first The number of the first event of the chunk.
+ @param n_samples The number of samples of each waveform.
+ @param compress If true the channel blocks are encoded with @ref WaveformCodec.
+ */
+void DAQArchive::WriteChunk(ofstream &o, Buffer &buffer, vector<Chunk> &index, unsigned long long first, unsigned int n_samples, bool compress)
+{
+    Chunk chunk;
+    unsigned int n_channels = buffer.adc.size();
+    chunk.offset = o.tellp();
+    chunk.first = first;
+    chunk.n_events = buffer.eh.size();
+
+    o.write((char *)buffer.eh.data(), buffer.eh.size() * sizeof(EventHeader));
+    for (auto &tCell : buffer.tCell)
+    {
+        o.write((char *)tCell.data(), tCell.size() * sizeof(unsigned short));
+        tCell.clear();
+    }
+    for (auto &scaler : buffer.scaler)
+    {
+        o.write((char *)scaler.data(), scaler.size() * sizeof(unsigned int));
+        scaler.clear();
+    }
+    vector<unsigned char> block;
+    for (unsigned int k = 0; k < n_channels; ++k)
+    {
+        chunk.ch_offset.push_back(o.tellp());
+        if (compress)
+        {
+            block.clear();
+            for (unsigned int e = 0; e < chunk.n_events; ++e)
+            {
+                WaveformCodec::Encode(buffer.adc[k].data() + e * n_samples, n_samples, block);
+            }
+            chunk.ch_size.push_back(block.size());
+            chunk.ch_encoding.push_back(ENCODING_CODEC);
+            o.write((char *)block.data(), block.size());
+        }
+        else
+        {
+            chunk.ch_size.push_back(buffer.adc[k].size() * sizeof(unsigned short));
+            chunk.ch_encoding.push_back(ENCODING_RAW);
+            o.write((char *)buffer.adc[k].data(), buffer.adc[k].size() * sizeof(unsigned short));
+        }
+        buffer.adc[k].clear();
+    }
+    buffer.eh.clear();
+
+    index.push_back(chunk);
+}
+
+/*!
+ @brief Method to open an archive given the file path and name.
+
+ @param fname
+ @return DAQArchive&
+ */
+DAQArchive &DAQArchive::Open(const string &fname)
+{
+    if (in_.is_open())
+    {
+        cerr << "!! Error: File is already opened --> " << filename_ << endl;
+        return *this;
+    }
+
+    filename_ = fname;
+    in_.open(fname, std::ios::in | std::ios::binary);
+    cout << "Created DAQArchive, opened file " << fname << endl;
+    initialization_ = 0;
+    return (*this).Initialise();
+}
+
+/*!
+ @brief Method to close the archive.
+
+ @return DAQArchive&
+ */
+DAQArchive &DAQArchive::Close()
+{
+    if (in_.is_open())
+    {
+        cout << "Closing file " << filename_ << "..." << endl;
+        in_.close();
+    }
+    else
+    {
+        cout << "File is already closed" << endl;
+    }
+    initialization_ = 0;
+    return *this;
+}
+
+/*!
+ @brief Method to reset the archive, the next event read is the first one.
+
+ @return DAQArchive&
+ */
+DAQArchive &DAQArchive::Reset()
+{
+    cursor_ = 0;
+    return *this;
+}
+
+/*!
+ @brief Method to select what event must be read next.
+
+ @details Thanks to the index the position of the event is known, nothing is read from the file until `archive >> event` is called.
+
+ @param evt_id The position of the event in the archive, starting from 0.
+ @return DAQArchive&
+ */
+DAQArchive &DAQArchive::GetEvent(long evt_id)
+{
+    if (evt_id < 0 or (unsigned long long)evt_id >= n_events_)
+    {
+        cerr << "!! Error : Invalid event " << evt_id << ", the archive has " << n_events_ << " events" << endl
+             << "Reset position to first event..." << endl;
+        cursor_ = 0;
+        return *this;
+    }
+
+    cursor_ = evt_id;
+    return *this;
+}
+
+/*!
+ @brief Select the channels to be read.
+
+ @details Only the blocks of the selected channels are read from the archive, the @ref DAQEvent filled contains only these channels: the other
+ channels are erased from the event, so @ref DAQEvent::GetChannel() exits with an error for them instead of giving the waveform of a previous event.
+ It must be called before reading the events. An empty vector selects all the channels.
+
+ @param channels The pairs of board and channel indices.
+ @return DAQArchive&
+ */
+DAQArchive &DAQArchive::SetChannels(const vector<pair<int, int>> &channels)
+{
+    selected_.assign(channels_.size(), channels.empty());
+    for (auto &ch : channels)
+    {
+        auto it = find(channels_.begin(), channels_.end(), ch);
+        if (it == channels_.end())
+        {
+            cerr << "!! Error : Couldn't find board-channel of ID (" << ch.first << ", " << ch.second << ")" << endl;
+            exit(0);
+        }
+        selected_[distance(channels_.begin(), it)] = true;
+    }
+    chunk_loaded_ = -1;
+    return *this;
+}
+
+/*!
+ @brief Read the file header and the index of the archive.
+
+ @return DAQArchive&
+ */
+DAQArchive &DAQArchive::Initialise()
+{
+    if (!in_.is_open())
+    {
+        cerr << "!! Error: file not open --> use DAQArchive(filename)" << endl;
+        return *this;
+    }
+
+    char magic[4];
+    char type[5] = {0, 0, 0, 0, 0};
+    unsigned int version, is_lab, n_boards;
+
+    in_.read(magic, 4);
+    in_.read((char *)&version, sizeof(unsigned int));
+    if (memcmp(magic, ARCHIVE_MAGIC, 4) != 0 or version < 1 or version > ARCHIVE_VERSION)
+    {
+        cerr << "!! Error: invalid archive header in " << filename_ << endl;
+        cerr << "Initialisation failed" << endl;
+        return *this;
+    }
+
+    in_.read(type, 4);
+    in_.read((char *)&is_lab, sizeof(unsigned int));
+    in_.read((char *)&n_boards, sizeof(unsigned int));
+    n_samples_ = SAMPLES_PER_WAVEFORM;
+    if (version >= 2)
+    {
+        in_.read((char *)&n_samples_, sizeof(unsigned int));
+    }
+    type_ = type;
+    is_lab_ = is_lab;
+    cout << "Initializing archive " << filename_ << " --> " << type_ << endl;
+
+    times_.clear();
+    board_serials_.clear();
+    channels_.clear();
+    vector<float> times(SAMPLES_PER_WAVEFORM);
+    for (unsigned int i = 0; i < n_boards; ++i)
+    {
+        unsigned short serial;
+        unsigned int n_ch;
+        in_.read((char *)&serial, sizeof(unsigned short));
+        in_.read((char *)&n_ch, sizeof(unsigned int));
+        board_serials_.push_back(serial);
+        for (unsigned int j = 0; j < n_ch; ++j)
+        {
+            in_.read((char *)times.data(), SAMPLES_PER_WAVEFORM * sizeof(float));
+            times_[i][j] = times;
+            channels_.push_back({(int)i, (int)j});
+        }
+    }
+    in_.read((char *)&chunk_size_, sizeof(unsigned int));
+
+    // Index
+    unsigned long long index_pos;
+    unsigned int n_chunks;
+    in_.seekg(-(long)(sizeof(unsigned long long) + 4), in_.end);
+    in_.read((char *)&index_pos, sizeof(unsigned long long));
+    in_.read(magic, 4);
+    if (!in_.good() or memcmp(magic, INDEX_MAGIC, 4) != 0)
+    {
+        cerr << "!! Error: index not found in " << filename_ << ", the archive is truncated" << endl;
+        cerr << "Initialisation failed" << endl;
+        return *this;
+    }
+
+    in_.seekg(index_pos);
+    in_.read((char *)&n_events_, sizeof(unsigned long long));
+    in_.read((char *)&n_chunks, sizeof(unsigned int));
+    index_.resize(n_chunks);
+    for (auto &chunk : index_)
+    {
+        in_.read((char *)&chunk.offset, sizeof(unsigned long long));
+        in_.read((char *)&chunk.first, sizeof(unsigned long long));
+        in_.read((char *)&chunk.n_events, sizeof(unsigned int));
+        chunk.ch_offset.resize(channels_.size());
+        chunk.ch_size.resize(channels_.size());
+        chunk.ch_encoding.resize(channels_.size());
+        for (unsigned int k = 0; k < channels_.size(); ++k)
+        {
+            in_.read((char *)&chunk.ch_offset[k], sizeof(unsigned long long));
+            in_.read((char *)&chunk.ch_size[k], sizeof(unsigned int));
+            in_.read((char *)&chunk.ch_encoding[k], sizeof(unsigned int));
+        }
+    }
+
+    if (!in_.good())
+    {
+        cerr << "!! Error: invalid index in " << filename_ << endl;
+        cerr << "Initialisation failed" << endl;
+        return *this;
+    }
+
+    cout << n_events_ << " events in " << n_chunks << " chunks" << endl;
+    selected_.assign(channels_.size(), true);
+    buffer_.tCell.resize(channels_.size());
+    buffer_.scaler.resize(channels_.size());
+    buffer_.adc.resize(channels_.size());
+    cursor_ = 0;
+    chunk_loaded_ = -1;
+    initialization_ = true;
+    return *this;
+}
+
+/*!
+ @brief Load a chunk in @ref DAQArchive::buffer_.
+
+ @details Only the blocks of the channels selected with @ref DAQArchive::SetChannels() are read.
+
+ @param c The number of the chunk.
+ @return true
+ @return false
+ */
+bool DAQArchive::LoadChunk(unsigned int c)
+{
+    auto &chunk = index_[c];
+    unsigned int n = chunk.n_events;
+
+    in_.clear();
+    in_.seekg(chunk.offset);
+    buffer_.eh.resize(n);
+    in_.read((char *)buffer_.eh.data(), n * sizeof(EventHeader));
+    for (auto &tCell : buffer_.tCell)
+    {
+        tCell.resize(n);
+        in_.read((char *)tCell.data(), n * sizeof(unsigned short));
+    }
+    for (auto &scaler : buffer_.scaler)
+    {
+        scaler.resize(n);
+        in_.read((char *)scaler.data(), n * sizeof(unsigned int));
+    }
+
+    for (unsigned int k = 0; k < channels_.size(); ++k)
+    {
+        if (!selected_[k])
+        {
+            continue;
+        }
+
+        buffer_.adc[k].resize(n * n_samples_);
+        in_.seekg(chunk.ch_offset[k]);
+        if (chunk.ch_encoding[k] == ENCODING_RAW)
+        {
+            if (chunk.ch_size[k] != buffer_.adc[k].size() * sizeof(unsigned short))
+            {
+                cerr << "!! Error: invalid size of the block of channel (" << channels_[k].first << ", " << channels_[k].second << ") in chunk " << c << " of " << filename_ << endl;
+                return 0;
+            }
+            in_.read((char *)buffer_.adc[k].data(), chunk.ch_size[k]);
+        }
+        else if (chunk.ch_encoding[k] == ENCODING_CODEC)
+        {
+            block_.resize(chunk.ch_size[k]);
+            in_.read((char *)block_.data(), chunk.ch_size[k]);
+            if (!in_.good())
+            {
+                break;
+            }
+            size_t pos = 0;
+            for (unsigned int e = 0; e < n; ++e)
+            {
+                size_t read = WaveformCodec::Decode(block_.data() + pos, block_.size() - pos, n_samples_, buffer_.adc[k].data() + e * n_samples_);
+                if (read == 0)
+                {
+                    cerr << "!! Error: invalid or truncated block of channel (" << channels_[k].first << ", " << channels_[k].second << ") in chunk " << c << " of " << filename_ << endl;
+                    return 0;
+                }
+                pos += read;
+            }
+        }
+        else
+        {
+            cerr << "!! Error: unknown encoding " << chunk.ch_encoding[k] << " in " << filename_ << endl;
+            return 0;
+        }
+    }
+
+    if (!in_.good())
+    {
+        cerr << "!! Error: unable to read chunk " << c << " from " << filename_ << endl;
+        return 0;
+    }
+
+    chunk_loaded_ = c;
+    return 1;
+}
+
+/*!
+ @brief Remove a channel which is not read from the event.
+
+ @details The waveform, the times and the summary of the channel are erased, so that @ref DAQEvent::GetChannel() rejects the channel instead of
+ giving the waveform of a previous event.
+
+ @param event The event.
+ @param b The board.
+ @param c The channel.
+ */
+void DAQArchive::Erase(DAQEvent &event, int b, int c)
+{
+    if (event.volts_.find(b) == event.volts_.end())
+    {
+        return;
+    }
+
+    event.volts_[b].erase(c);
+    event.times_[b].erase(c);
+    event.stats_[b].erase(c);
+    event.tcell_[b].erase(c);
+    if (event.volts_[b].empty())
+    {
+        event.volts_.erase(b);
+        event.times_.erase(b);
+        event.stats_.erase(b);
+        event.tcell_.erase(b);
+    }
+
+    if (event.ch_.first == b and event.ch_.second == c)
+    {
+        event.ch_ = {-1, -1};
+        event.is_getch_ = false;
+    }
+}
+
+/*!
+ @brief Read into a @ref DRSEvent.
+
+ @param event
+ @return true
+ @return false
+ */
+bool DAQArchive::operator>>(DRSEvent &event) // DAQArchive >> DRSEvent
+{
+    return (*this).Fill(event, event.type_);
+}
+
+/*!
+ @brief Read into a @ref WDBEvent.
+
+ @param event
+ @return true
+ @return false
+ */
+bool DAQArchive::operator>>(WDBEvent &event) // DAQArchive >> WDBEvent
+{
+    return (*this).Fill(event, event.type_);
+}
+
+/*!
+ @brief Fill the event with the next event of the archive.
+
+ @details The ADC values are converted to Volts as in @ref DAQFile::Read() and the time calibration is performed with @ref DAQEvent::TimeCalibration(),
+ the event is then used as if it was read from the DRS/WDB binary file.
+
+ @param event The event to be filled.
+ @param type The type of the event, "DRS" or "WDB".
+ @return true
+ @return false
+ */
+bool DAQArchive::Fill(DAQEvent &event, const string &type)
+{
+    if (!initialization_)
+    {
+        return 0;
+    }
+
+    if (cursor_ >= n_events_)
+    {
+        cout << "End of file reached" << endl;
+        return 0;
+    }
+
+    if (type_ != type)
+    {
+        cerr << "!! Error: Invalid type of class used" << endl
+             << "Type expected: " << type_ << endl
+             << "Event given: " << type << endl;
+        exit(0);
+    }
+
+    if (!event.config_.is_makeconfig_)
+    {
+        cout << "Autocall to: DAQEvent::MakeConfig()...";
+        event.MakeConfig(*this);
+        cout << " Done!" << endl;
+    }
+
+    long c = cursor_ / chunk_size_;
+    if (c != chunk_loaded_ and !(*this).LoadChunk(c))
+    {
+        return 0;
+    }
+    unsigned long long e = cursor_ - index_[c].first;
+
+    event.eh_ = buffer_.eh[e];
+    if (event.eh_.serialNumber % 100 == 0 and event.eh_.serialNumber > 0)
+    {
+        cout << "Event serial number: " << event.eh_.serialNumber << endl;
+    }
+
+    event.is_init_ = true;
+    event.routine_ = {false, false, false};
+
+    for (unsigned int k = 0; k < channels_.size(); ++k)
+    {
+        auto [i, j] = channels_[k];
+        if (!selected_[k])
+        {
+            (*this).Erase(event, i, j);
+            continue;
+        }
+
+        event.SetVolts(buffer_.adc[k].data() + e * n_samples_, buffer_.tCell[k][e], n_samples_, i, j);
+        event.TimeCalibration(buffer_.tCell[k][e], times_[i][j], n_samples_, i, j);
+    }
+
+    ++cursor_;
+    return 1;
+}
@@ -0,0 +1,111 @@
+/*!
+ @file readWDArchive.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the readWD native archive format.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDARCHIVE_H
+#define READWDARCHIVE_H
+
+#include "readWD.hh"
+#include "readWDCodec.hh"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Class to write and read the readWD native archive.
+
+ @details The archive stores the content of a DRS/WDB binary file in a seekable layout, see @ref archive. The ```TIME``` block is stored once
+ in the file header, then the events are grouped in chunks. Inside a chunk the waveforms are grouped per channel, and an index at the end of the
+ file stores the position of every chunk and of every channel block.
+
+ The class is used as @ref DAQFile: redirecting the archive into a @ref DAQEvent instance one event is read. With @ref DAQArchive::SetChannels()
+ only the requested channels are read from disk.
+ */
+class DAQArchive
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+
+public:
+    DAQArchive();
+    DAQArchive(const std::string &);
+    ~DAQArchive() { in_.close(); }
+
+    static bool Convert(const std::string &, const std::string &, unsigned int = 1000, bool = true);
+
+    DAQArchive &Open(const std::string &);
+    DAQArchive &Close();
+    DAQArchive &Reset();
+
+    DAQArchive &GetEvent(long);
+    DAQArchive &SetChannels(const std::vector<std::pair<int, int>> &);
+    long GetNEvents() { return n_events_; };
+    int GetNSamples() { return n_samples_; };
+
+    bool operator>>(DRSEvent &);
+    bool operator>>(WDBEvent &);
+
+    const MAP &GetTimeMap() { return times_; };
+    const std::string &GetType() { return type_; };
+    const std::vector<unsigned short> &GetBoardSerials() { return board_serials_; };
+
+private:
+    /*!
+     @brief Position of a chunk and of its channel blocks, as stored in the index.
+     */
+    struct Chunk
+    {
+        unsigned long long offset;                 ///< Position of the chunk in the file.
+        unsigned long long first;                  ///< Number of the first event of the chunk, starting from 0.
+        unsigned int n_events;                     ///< Number of events in the chunk.
+        std::vector<unsigned long long> ch_offset; ///< Position of each channel block in the file.
+        std::vector<unsigned int> ch_size;         ///< Size in bytes of each channel block.
+        std::vector<unsigned int> ch_encoding;     ///< Encoding of each channel block, 0 for raw ADC values, 1 for @ref WaveformCodec.
+    };
+
+    /*!
+     @brief Content of a chunk, the waveforms are grouped per channel.
+     */
+    struct Buffer
+    {
+        std::vector<EventHeader> eh;                  ///< The event headers.
+        std::vector<std::vector<unsigned short>> tCell; ///< The trigger cells of each channel.
+        std::vector<std::vector<unsigned int>> scaler;  ///< The time scalers of each channel.
+        std::vector<std::vector<unsigned short>> adc;   ///< The ADC values of each channel, event after event.
+    };
+
+    static void WriteChunk(std::ofstream &, Buffer &, std::vector<Chunk> &, unsigned long long, unsigned int, bool);
+    DAQArchive &Initialise();
+    bool LoadChunk(unsigned int);
+    bool Fill(DAQEvent &, const std::string &);
+    void Erase(DAQEvent &, int, int);
+
+    std::string filename_;                      ///< The name of the file
+    std::ifstream in_;                          ///< The input file to read
+    bool initialization_;                       ///< Flag to store if @ref DAQArchive::Initialise() was already called
+    std::string type_;                          ///< The type of the board
+    bool is_lab_;                               ///< Flag to check if the board is from LAB or not
+    MAP times_;                                 ///< Struct to hold \f$ \Delta t\f$ of the ```TIME``` block
+    std::vector<unsigned short> board_serials_; ///< Serial numbers of the boards
+    std::vector<std::pair<int, int>> channels_; ///< Board and channel indices of each channel, in the order of the file
+    std::vector<bool> selected_;                ///< Channels to be read, see @ref DAQArchive::SetChannels()
+    unsigned int chunk_size_;                   ///< Number of events in each chunk, the last one can be smaller
+    unsigned int n_samples_;                    ///< Number of samples of each waveform
+    unsigned long long n_events_;               ///< Number of events in the archive
+    std::vector<Chunk> index_;                  ///< The index of the chunks
+    unsigned long long cursor_;                 ///< Number of the next event to be read
+    long chunk_loaded_;                         ///< Number of the chunk in @ref DAQArchive::buffer_, -1 if none
+    Buffer buffer_;                             ///< The chunk currently loaded
+    std::vector<unsigned char> block_;          ///< Encoded channel block read from the file
+};
+
+#endif
@@ -0,0 +1,303 @@
+/*!
+ @file readWDAverage.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the streaming average and RMS of the waveforms.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDAverage.hh"
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : WaveformAverage                                               │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new WaveformAverage object.
+
+ @details The number of points of each channel is the number of samples, the number of cells of the ```TIME``` block or the size of the window
+ around the peak, depending on the alignment.
+
+ @param times The map of \f$ \Delta t\f$ of the ```TIME``` block.
+ @param n_samples The number of samples of the waveforms.
+ @param alignment The alignment of the waveforms.
+ @param before The number of samples kept before the peak, for the alignment on the peak.
+ @param after The number of samples kept after the peak, for the alignment on the peak.
+ */
+WaveformAverage::WaveformAverage(const MAP &times, int n_samples, Alignment alignment, int before, int after) : channels_(times)
+{
+    alignment_ = alignment;
+    before_ = before;
+    after_ = after;
+
+    bool peak = alignment_ == Alignment::Minimum or alignment_ == Alignment::Maximum;
+    if (peak and (before_ < 0 or after_ < 0 or before_ + after_ + 1 > n_samples))
+    {
+        cerr << "!! Error: window of " << before_ << " samples before and " << after_ << " after the peak, the waveforms have " << n_samples << endl;
+        exit(0);
+    }
+
+    for (auto &[bKey, bVal] : times)
+    {
+        for (auto &[cKey, dt] : bVal)
+        {
+            int size = n_samples;
+            if (alignment_ == Alignment::Cell)
+            {
+                size = dt.size();
+            }
+            else if (peak)
+            {
+                size = before_ + after_ + 1;
+            }
+
+            moments_.push_back({vector<double>(size, 0), vector<double>(size, 0), vector<double>(size, 0), 0});
+        }
+    }
+    if (moments_.empty())
+    {
+        cerr << "!! Error: no channels to be averaged" << endl;
+        exit(0);
+    }
+}
+
+/*!
+ @brief Add consecutive samples to consecutive points with the Welford update.
+
+ @details The points are independent of each other, so the loop is vectorised by the compiler.
+
+ @param m The moments of the channel.
+ @param first The first point.
+ @param x The samples.
+ @param len The number of samples.
+ */
+void WaveformAverage::Update(Moments &m, int first, const float *x, int len)
+{
+    double *n = m.n.data() + first;
+    double *mean = m.mean.data() + first;
+    double *m2 = m.m2.data() + first;
+    for (int k = 0; k < len; ++k)
+    {
+        double nk = n[k] + 1;
+        double d = x[k] - mean[k];
+        double mk = mean[k] + d / nk;
+        m2[k] += d * (x[k] - mk);
+        mean[k] = mk;
+        n[k] = nk;
+    }
+}
+
+/*!
+ @brief Add a channel of an event.
+
+ @param event The event.
+ @param b The board.
+ @param c The channel.
+ @return WaveformAverage&
+ */
+WaveformAverage &WaveformAverage::Add(DAQEvent &event, int b, int c)
+{
+    auto &m = moments_[channels_.Index(b, c)];
+    auto &volts = event.GetChannel(b, c).GetVolts();
+    int n_samples = volts.size();
+    int size = m.mean.size();
+
+    switch (alignment_)
+    {
+    case Alignment::Sample:
+    {
+        if (n_samples != size)
+        {
+            cerr << "!! Error: waveform of " << n_samples << " samples, the average expects " << size << endl;
+            exit(0);
+        }
+        WaveformAverage::Update(m, 0, volts.data(), n_samples);
+        break;
+    }
+    case Alignment::Cell:
+    {
+        int tCell = event.GetChannel(b, c).GetTriggerCell() % size;
+        if (n_samples > size)
+        {
+            cerr << "!! Error: waveform of " << n_samples << " samples, the chip has " << size << " cells" << endl;
+            exit(0);
+        }
+        int first = min(n_samples, size - tCell);
+        WaveformAverage::Update(m, tCell, volts.data(), first);
+        WaveformAverage::Update(m, 0, volts.data() + first, n_samples - first);
+        break;
+    }
+    case Alignment::Minimum:
+    case Alignment::Maximum:
+    {
+        auto &stats = event.GetChannel(b, c).GetStats();
+        int peak = alignment_ == Alignment::Minimum ? stats.argmin : stats.argmax;
+        if (peak - before_ < 0 or peak + after_ >= n_samples)
+        {
+            return *this;
+        }
+        WaveformAverage::Update(m, 0, volts.data() + peak - before_, size);
+        break;
+    }
+    }
+    ++m.waveforms;
+    return *this;
+}
+
+/*!
+ @brief Add all the channels of an event.
+
+ @param event The event.
+ @return WaveformAverage&
+ */
+WaveformAverage &WaveformAverage::Add(DAQEvent &event)
+{
+    for (auto &[bKey, bVal] : channels_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            (*this).Add(event, bKey, cKey);
+        }
+    }
+    return *this;
+}
+
+/*!
+ @brief Join the waveforms added to another instance, for example filled by another thread.
+
+ @details The moments of each point are combined with the formula of Chan et al.: with \f$ \delta = \bar x_B - \bar x_A\f$,
+ \f[ n = n_A + n_B, \qquad \bar x = \bar x_A + \delta \frac{n_B}{n}, \qquad M_2 = M_{2,A} + M_{2,B} + \delta^2 \frac{n_A n_B}{n}. \f]
+ The other instance must have the same channels, points and alignment.
+
+ @param other The other instance, not modified.
+ @return WaveformAverage&
+ */
+WaveformAverage &WaveformAverage::Merge(const WaveformAverage &other)
+{
+    if (channels_ != other.channels_ or alignment_ != other.alignment_ or before_ != other.before_ or after_ != other.after_)
+    {
+        cerr << "!! Error: the averages to be merged have different channels or alignment" << endl;
+        exit(0);
+    }
+
+    for (size_t i = 0; i < moments_.size(); ++i)
+    {
+        auto &a = moments_[i];
+        auto &b = other.moments_[i];
+        int size = a.mean.size();
+        for (int k = 0; k < size; ++k)
+        {
+            double n = a.n[k] + b.n[k];
+            double d = b.mean[k] - a.mean[k];
+            double w = n > 0 ? b.n[k] / n : 0;
+            a.mean[k] += d * w;
+            a.m2[k] += b.m2[k] + d * d * a.n[k] * w;
+            a.n[k] = n;
+        }
+        a.waveforms += b.waveforms;
+    }
+    return *this;
+}
+
+/*!
+ @brief Remove all the waveforms added.
+
+ @return WaveformAverage&
+ */
+WaveformAverage &WaveformAverage::Reset()
+{
+    for (auto &m : moments_)
+    {
+        fill(m.n.begin(), m.n.end(), 0);
+        fill(m.mean.begin(), m.mean.end(), 0);
+        fill(m.m2.begin(), m.m2.end(), 0);
+        m.waveforms = 0;
+    }
+    return *this;
+}
+
+/*!
+ @brief Getter method for the mean of each point of a channel.
+
+ @param b The board.
+ @param c The channel.
+ @return vector<float> The mean in Volts, 0 for the points without entries.
+ */
+vector<float> WaveformAverage::GetMean(int b, int c)
+{
+    auto &m = moments_[channels_.Index(b, c)];
+    return vector<float>(m.mean.begin(), m.mean.end());
+}
+
+/*!
+ @brief Getter method for the RMS of each point of a channel around its mean.
+
+ @param b The board.
+ @param c The channel.
+ @return vector<float> The standard deviation in Volts, \f$ \sqrt{M_2 / (n - 1)}\f$, 0 for the points with less than two entries.
+ */
+vector<float> WaveformAverage::GetRMS(int b, int c)
+{
+    auto &m = moments_[channels_.Index(b, c)];
+    vector<float> rms(m.m2.size(), 0);
+    for (size_t k = 0; k < rms.size(); ++k)
+    {
+        if (m.n[k] > 1)
+        {
+            rms[k] = sqrt(m.m2[k] / (m.n[k] - 1));
+        }
+    }
+    return rms;
+}
+
+/*!
+ @brief Getter method for the number of entries of each point of a channel.
+
+ @details With the alignment on the samples every point has an entry for each waveform, with the alignment on the cells only the cells read out
+ are filled, with the alignment on the peak the waveforms without the whole window are not added.
+
+ @param b The board.
+ @param c The channel.
+ @return vector<long>
+ */
+vector<long> WaveformAverage::GetEntries(int b, int c)
+{
+    auto &m = moments_[channels_.Index(b, c)];
+    return vector<long>(m.n.begin(), m.n.end());
+}
+
+/*!
+ @brief Getter method for the number of waveforms of a channel added.
+
+ @param b The board.
+ @param c The channel.
+ @return long
+ */
+long WaveformAverage::GetNWaveforms(int b, int c)
+{
+    return moments_[channels_.Index(b, c)].waveforms;
+}
+
+/*!
+ @brief Getter method for the boards and channels averaged.
+
+ @return vector<pair<int, int>>
+ */
+vector<pair<int, int>> WaveformAverage::GetChannels()
+{
+    vector<pair<int, int>> channels;
+    for (auto &[bKey, bVal] : channels_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            channels.push_back({bKey, cKey});
+        }
+    }
+    return channels;
+}
@@ -0,0 +1,115 @@
+/*!
+ @file readWDAverage.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the streaming average and RMS of the waveforms.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDAVERAGE_H
+#define READWDAVERAGE_H
+
+#include "readWD.hh"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Class to accumulate the mean waveform and the RMS of each sample over a whole run.
+
+ @details The waveforms are not stored: for each point of each channel the number of entries, the mean and the sum of the squared deviations are
+ updated with the Welford algorithm, which does not lose precision when the mean is much larger than the spread. The points are updated together,
+ in a loop vectorised by the compiler, in double precision. The point filled by a sample depends on the alignment:
+    - @ref WaveformAverage::Alignment::Sample, the index of the sample, for the mean waveform and the noise of each sample;
+    - @ref WaveformAverage::Alignment::Cell, the cell of the DRS chip that recorded the sample, that is the index shifted by the trigger cell, for the
+      offset and the noise of each cell;
+    - @ref WaveformAverage::Alignment::Minimum or @ref WaveformAverage::Alignment::Maximum, the distance from the peak of the waveform, for the mean
+      pulse. Only the samples from a number of samples before to a number of samples after the peak are kept, the waveforms that do not contain
+      the whole window are skipped. The peak is the one found while the event is decoded, see @ref DAQEvent::GetStats().
+
+ An instance is not shared between threads: with @ref DAQDataset::Process() each thread fills its own instance, the partial results are then joined
+ with @ref WaveformAverage::Merge(), which gives the same result as one instance filled with all the events.
+
+ @code{.cpp}
+ DAQDataset dataset("path/to/run*.dat");
+ DAQFile file("path/to/run0.dat"); // For the channels and the number of samples
+ vector<WaveformAverage> partial(n_threads, WaveformAverage(file, WaveformAverage::Alignment::Cell));
+
+ dataset.Process([&](DRSEvent &event, long evt, unsigned int thread)
+                 { partial[thread].Add(event); }, n_threads);
+ for (unsigned int t = 1; t < n_threads; ++t)
+ {
+     partial[0].Merge(partial[t]);
+ }
+ auto offset = partial[0].GetMean(0, 1); // offset[k] of cell k
+ auto noise = partial[0].GetRMS(0, 1);
+ @endcode
+ */
+class WaveformAverage
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+
+public:
+    /*!
+     @brief The point of the average filled by each sample.
+     */
+    enum class Alignment
+    {
+        Sample,  ///< The index of the sample.
+        Cell,    ///< The cell of the DRS chip, the index of the sample shifted by the trigger cell.
+        Minimum, ///< The distance from the minimum of the waveform.
+        Maximum  ///< The distance from the maximum of the waveform.
+    };
+
+    WaveformAverage(const MAP &, int, Alignment = Alignment::Sample, int = 0, int = 0);
+    /*!
+     @brief Construct a new WaveformAverage object for the channels of a file.
+
+     @param file The file, its ```TIME``` block and its number of samples are used.
+     @param alignment The alignment of the waveforms.
+     @param before The number of samples kept before the peak, for the alignment on the peak.
+     @param after The number of samples kept after the peak, for the alignment on the peak.
+     */
+    WaveformAverage(DAQFile &file, Alignment alignment = Alignment::Sample, int before = 0, int after = 0)
+        : WaveformAverage(file.GetTimeMap(), file.GetNSamples(), alignment, before, after) {}
+
+    WaveformAverage &Add(DAQEvent &);
+    WaveformAverage &Add(DAQEvent &, int, int);
+    WaveformAverage &Merge(const WaveformAverage &);
+    WaveformAverage &Reset();
+
+    std::vector<float> GetMean(int, int);
+    std::vector<float> GetRMS(int, int);
+    std::vector<long> GetEntries(int, int);
+    long GetNWaveforms(int, int);
+    std::vector<std::pair<int, int>> GetChannels();
+    Alignment GetAlignment() { return alignment_; };
+
+private:
+    /*!
+     @brief The running moments of the points of a channel.
+     */
+    struct Moments
+    {
+        std::vector<double> n;    ///< The number of entries of each point.
+        std::vector<double> mean; ///< The mean of each point.
+        std::vector<double> m2;   ///< The sum of the squared deviations from the mean of each point.
+        long waveforms;           ///< The number of waveforms added.
+    };
+
+    static void Update(Moments &, int, const float *, int);
+
+    Alignment alignment_;                        ///< The alignment of the waveforms
+    int before_;                                 ///< Samples kept before the peak
+    int after_;                                  ///< Samples kept after the peak
+    ChannelIndex channels_;                      ///< Index of each board and channel in the moments
+    std::vector<Moments> moments_;               ///< The moments of each channel
+};
+
+#endif
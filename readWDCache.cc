@@ -0,0 +1,308 @@
+/*!
+ @file readWDCache.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the persistent cache of channel features.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDCache.hh"
+
+#include <filesystem>
+
+using namespace std;
+
+static const char CACHE_MAGIC[4] = {'R', 'W', 'D', 'F'}; ///< First word of the cache file.
+static const unsigned int CACHE_VERSION = 2;           ///< Version of the cache layout, to be increased when @ref DAQFeatures changes.
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : DAQFeatureCache                                               │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new DAQFeatureCache::DAQFeatureCache object.
+
+ @details Nothing is read until @ref DAQFeatureCache::Evaluate() is called.
+
+ @param fname The name of the cache file, it is created if it does not exist.
+ @param cf The constant fraction used to evaluate @ref DAQFeatures::timeCF.
+ */
+DAQFeatureCache::DAQFeatureCache(const string &fname, float cf)
+{
+    filename_ = fname;
+    cf_ = cf;
+    file_hash_ = 0;
+}
+
+/*!
+ @brief Evaluate the features of all the channels of a DRS file, reusing the cached ones.
+
+ @param file The file to be read.
+ @param event The event, its configuration is used to evaluate the features.
+ @return DAQFeatureCache&
+ */
+DAQFeatureCache &DAQFeatureCache::Evaluate(DAQFile &file, DRSEvent &event)
+{
+    return (*this).EvaluateImpl(file, event);
+}
+
+/*!
+ @brief Evaluate the features of all the channels of a WDB file, reusing the cached ones.
+
+ @param file The file to be read.
+ @param event The event, its configuration is used to evaluate the features.
+ @return DAQFeatureCache&
+ */
+DAQFeatureCache &DAQFeatureCache::Evaluate(DAQFile &file, WDBEvent &event)
+{
+    return (*this).EvaluateImpl(file, event);
+}
+
+/*!
+ @brief Evaluate the features of the channels not found in the cache.
+
+ @details The cache file is read if it refers to the same input file. For each channel the hash of its settings is compared with the cached one,
+ the channels that differ (or are missing) are evaluated reading the whole file once, then the cache file is written. The file is read with a
+ separate @ref DAQFile, so that the features are one for each event of the file, in order: the selections (see @ref DAQFile::SelectSerials()), the
+ trigger condition (see @ref DAQFile::SetTrigger()) and the recovery mode (see @ref DAQFile::SetRecovery()) of `file` are not applied, and its position
+ is not changed.
+
+ @param file The file to be read.
+ @param event The event, a @ref DRSEvent or a @ref WDBEvent.
+ @return DAQFeatureCache&
+ */
+template <typename T>
+DAQFeatureCache &DAQFeatureCache::EvaluateImpl(DAQFile &file, T &event)
+{
+    if (!event.config_.is_makeconfig_)
+    {
+        cout << "Autocall to: DAQEvent::MakeConfig()...";
+        event.MakeConfig(file);
+        cout << " Done!" << endl;
+    }
+
+    auto file_hash = (*this).FileHash(file);
+    if (file_hash != file_hash_)
+    {
+        entries_.clear();
+        (*this).Load(file_hash);
+        file_hash_ = file_hash;
+    }
+
+    unsigned long n_events = file.GetNEvents();
+    vector<pair<int, int>> stale;
+    for (auto &[bKey, bVal] : event.config_.pedInterval_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            auto config_hash = (*this).ConfigHash(event.config_, bKey, cKey);
+            auto &entry = entries_[bKey][cKey];
+            if (entry.config_hash == config_hash) // The entries are written only after a pass over the whole file
+            {
+                continue;
+            }
+            entry.config_hash = config_hash;
+            entry.events.clear();
+            entry.events.reserve(n_events);
+            stale.push_back({bKey, cKey});
+        }
+    }
+
+    if (stale.empty())
+    {
+        cout << "Features of all channels found in " << filename_ << endl;
+        return *this;
+    }
+
+    cout << "Evaluating features of " << stale.size() << " channel(s)..." << endl;
+    DAQFile pass(file.GetFileName());
+    while (pass >> event)
+    {
+        for (auto &[b, c] : stale)
+        {
+            DAQFeatures features;
+            auto &ped = event.GetChannel(b, c).GetPedestal();
+            features.pedestal = ped.first;
+            features.pedestalRMS = ped.second;
+            features.charge = event.GetChannel(b, c).GetCharge();
+            features.amplitude = event.GetChannel(b, c).GetAmplitude();
+            features.timeCF = event.GetChannel(b, c).GetTimeCF(cf_);
+            entries_[b][c].events.push_back(features);
+        }
+    }
+
+    (*this).Save();
+    return *this;
+}
+
+/*!
+ @brief Getter method read-only for the features of a channel.
+
+ @param b The board.
+ @param c The channel.
+ @return const vector<DAQFeatures>& The features, one for each event of the file, in order (see @ref DAQFeatureCache::Evaluate()).
+ */
+const vector<DAQFeatures> &DAQFeatureCache::GetFeatures(int b, int c)
+{
+    if (entries_.find(b) != entries_.end())
+    {
+        if (entries_[b].find(c) != entries_[b].end())
+        {
+            return entries_[b][c].events;
+        }
+    }
+    cerr << "!! Error : Couldn't find board-channel of ID (" << b << ", " << c << "), use DAQFeatureCache::Evaluate()" << endl;
+    exit(0);
+}
+
+/*!
+ @brief Read the cache file.
+
+ @param file_hash The hash of the input file, the cache file is used only if it was written for the same input file.
+ @return true
+ @return false
+ */
+bool DAQFeatureCache::Load(unsigned long long file_hash)
+{
+    ifstream in(filename_, std::ios::in | std::ios::binary);
+    if (!in.is_open())
+    {
+        return 0;
+    }
+
+    char magic[4];
+    unsigned int version, n_entries;
+    unsigned long long hash;
+    in.read(magic, 4);
+    in.read((char *)&version, sizeof(unsigned int));
+    in.read((char *)&hash, sizeof(unsigned long long));
+    if (!in.good() or memcmp(magic, CACHE_MAGIC, 4) != 0 or version != CACHE_VERSION or hash != file_hash)
+    {
+        cout << "Cache file " << filename_ << " refers to another file or version, features will be evaluated again" << endl;
+        return 0;
+    }
+
+    in.read((char *)&n_entries, sizeof(unsigned int));
+    for (unsigned int i = 0; i < n_entries and in.good(); ++i)
+    {
+        int b, c;
+        unsigned long long config_hash, n_events;
+        in.read((char *)&b, sizeof(int));
+        in.read((char *)&c, sizeof(int));
+        in.read((char *)&config_hash, sizeof(unsigned long long));
+        in.read((char *)&n_events, sizeof(unsigned long long));
+
+        auto &entry = entries_[b][c];
+        entry.config_hash = config_hash;
+        entry.events.resize(n_events);
+        in.read((char *)entry.events.data(), n_events * sizeof(DAQFeatures));
+    }
+
+    if (!in.good())
+    {
+        cerr << "!! Error: cache file " << filename_ << " is truncated, features will be evaluated again" << endl;
+        entries_.clear();
+        return 0;
+    }
+    return 1;
+}
+
+/*!
+ @brief Write the cache file.
+
+ @return true
+ @return false
+ */
+bool DAQFeatureCache::Save()
+{
+    ofstream o(filename_, std::ios::out | std::ios::binary);
+    if (!o.is_open())
+    {
+        cerr << "!! Error: unable to write cache file " << filename_ << endl;
+        return 0;
+    }
+
+    unsigned int n_entries = 0;
+    for (auto &[bKey, bVal] : entries_)
+    {
+        n_entries += bVal.size();
+    }
+
+    o.write(CACHE_MAGIC, 4);
+    o.write((char *)&CACHE_VERSION, sizeof(unsigned int));
+    o.write((char *)&file_hash_, sizeof(unsigned long long));
+    o.write((char *)&n_entries, sizeof(unsigned int));
+    for (auto &[bKey, bVal] : entries_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            unsigned long long n_events = cVal.events.size();
+            o.write((char *)&bKey, sizeof(int));
+            o.write((char *)&cKey, sizeof(int));
+            o.write((char *)&cVal.config_hash, sizeof(unsigned long long));
+            o.write((char *)&n_events, sizeof(unsigned long long));
+            o.write((char *)cVal.events.data(), n_events * sizeof(DAQFeatures));
+        }
+    }
+    return o.good();
+}
+
+/*!
+ @brief Evaluate the hash of the identity of the input file.
+
+ @details The absolute path, the size and the time of last modification of the file are used, so that the hash changes if the file is rewritten.
+
+ @param file The input file.
+ @return unsigned long long
+ */
+unsigned long long DAQFeatureCache::FileHash(DAQFile &file)
+{
+    error_code ec;
+    auto path = filesystem::absolute(file.GetFileName(), ec).string();
+    auto size = filesystem::file_size(file.GetFileName(), ec);
+    auto time = filesystem::last_write_time(file.GetFileName(), ec).time_since_epoch().count();
+
+    auto hash = HashFNV(path.data(), path.size());
+    hash = HashFNV(&size, sizeof(size), hash);
+    hash = HashFNV(&time, sizeof(time), hash);
+    return hash;
+}
+
+/*!
+ @brief Evaluate the hash of the settings of a channel.
+
+ @details The integration window is considered only if it was set by the user, otherwise it is evaluated event by event and does not
+ change the features. The filter and the offsets of the cells of the channel are considered, as the features are evaluated on the filtered
+ waveform with the offsets subtracted (see @ref DAQConfig::SetOffsetCalibration()). A channel without offsets keeps the same hash, so the caches already written stay valid.
+
+ @param config The configuration.
+ @param b The board.
+ @param c The channel.
+ @return unsigned long long
+ */
+unsigned long long DAQFeatureCache::ConfigHash(DAQConfig &config, int b, int c)
+{
+    bool user_iw = config.user_iw_[b][c];
+    auto iw = user_iw ? config.intWindow_[b][c] : pair<int, int>{0, 0};
+    auto &ped = config.pedInterval_[b][c];
+    auto thr = config.peakThr_[b][c];
+
+    auto hash = HashFNV(&user_iw, sizeof(user_iw));
+    hash = HashFNV(&iw.first, sizeof(int), hash);
+    hash = HashFNV(&iw.second, sizeof(int), hash);
+    hash = HashFNV(&ped.first, sizeof(int), hash);
+    hash = HashFNV(&ped.second, sizeof(int), hash);
+    hash = HashFNV(&thr, sizeof(float), hash);
+    hash = HashFNV(&cf_, sizeof(float), hash);
+    hash = config.filter_[b][c].Hash(hash);
+    auto &offset = config.offset_[b][c];
+    if (!offset.empty())
+    {
+        hash = HashFNV(offset.data(), offset.size() * sizeof(float), hash);
+    }
+    return hash;
+}
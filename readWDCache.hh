@@ -0,0 +1,92 @@
+/*!
+ @file readWDCache.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the persistent cache of channel features.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDCACHE_H
+#define READWDCACHE_H
+
+#include "readWD.hh"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Features of one channel in one event, as evaluated by @ref DAQEvent.
+ */
+struct DAQFeatures
+{
+    float pedestal;    ///< The pedestal mean, see @ref DAQEvent::GetPedestal().
+    float pedestalRMS; ///< The pedestal std.dev., see @ref DAQEvent::GetPedestal().
+    float charge;      ///< The charge, see @ref DAQEvent::GetCharge().
+    float amplitude;   ///< The amplitude, see @ref DAQEvent::GetAmplitude().
+    float timeCF;      ///< The time at constant fraction, see @ref DAQEvent::GetTimeCF().
+};
+
+/*!
+ @brief Class to store on disk the features of every channel and reuse them in later analyses.
+
+ @details The features of each channel are stored with two keys: a hash of the identity of the input file (path, size and last modification time)
+ and a hash of the settings of the channel in @ref DAQConfig (integration window, pedestal interval, peak threshold) and of the constant fraction.
+ When @ref DAQFeatureCache::Evaluate() is called, only the channels whose keys changed are evaluated again reading the file, the others are taken from
+ the cache file. The features are those of all the events of the file, in order: the selections, the trigger condition and the recovery mode set on
+ the @ref DAQFile are not applied.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+ DAQFeatureCache cache("path/to/data.features");
+
+ event.MakeConfig(file);
+ event.GetChannel(0, 1).SetPedInterval(100, 200);
+
+ cache.Evaluate(file, event);
+ for (auto &features : cache.GetFeatures(0, 1))
+ {
+     h1->Fill(features.charge);
+ }
+ @endcode
+ */
+class DAQFeatureCache
+{
+public:
+    DAQFeatureCache(const std::string &, float = 0.5);
+
+    DAQFeatureCache &Evaluate(DAQFile &, DRSEvent &);
+    DAQFeatureCache &Evaluate(DAQFile &, WDBEvent &);
+
+    const std::vector<DAQFeatures> &GetFeatures(int, int);
+
+private:
+    /*!
+     @brief Features of one channel for all the events, with the key of the settings used.
+     */
+    struct Entry
+    {
+        unsigned long long config_hash;  ///< Hash of the settings of the channel.
+        std::vector<DAQFeatures> events; ///< The features of each event.
+    };
+
+    template <typename T>
+    DAQFeatureCache &EvaluateImpl(DAQFile &, T &);
+    bool Load(unsigned long long);
+    bool Save();
+    unsigned long long FileHash(DAQFile &);
+    unsigned long long ConfigHash(DAQConfig &, int, int);
+
+    std::string filename_;                              ///< The name of the cache file
+    float cf_;                                          ///< Constant fraction used for @ref DAQFeatures::timeCF
+    unsigned long long file_hash_;                      ///< Hash of the input file of the features stored
+    std::map<int, std::map<int, Entry>> entries_;       ///< The features of each board and channel
+};
+
+#endif
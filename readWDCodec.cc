@@ -0,0 +1,257 @@
+/*!
+ @file readWDCodec.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the lossless codec for 16-bit waveforms.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDCodec.hh"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : WaveformCodec                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Number of bits needed to store a value.
+
+ @param val
+ @return int
+ */
+static int BitWidth(unsigned int val)
+{
+    int b = 0;
+    while (val >> b)
+    {
+        ++b;
+    }
+    return b;
+}
+
+/*!
+ @brief Encode a waveform, the encoded bytes are appended to the output vector.
+
+ @param in The ADC values.
+ @param n The number of samples.
+ @param out The output vector.
+ @return size_t The number of bytes appended.
+ */
+size_t WaveformCodec::Encode(const unsigned short *in, size_t n, vector<unsigned char> &out)
+{
+    unsigned short block[CODEC_BLOCK];
+    unsigned short delta[CODEC_BLOCK];
+    unsigned short packed[CODEC_BLOCK];
+    size_t start_size = out.size();
+
+    for (size_t start = 0; start < n; start += CODEC_BLOCK)
+    {
+        size_t len = min<size_t>(CODEC_BLOCK, n - start);
+        copy(in + start, in + start + len, block);
+        fill(block + len, block + CODEC_BLOCK, block[len - 1]); // Padding of the last block
+
+        // Frame of reference
+        unsigned short min_val = *min_element(block, block + CODEC_BLOCK);
+        unsigned short max_val = *max_element(block, block + CODEC_BLOCK);
+        int b_for = BitWidth(max_val - min_val);
+
+        // Delta, zigzag encoded
+        unsigned int max_delta = 0;
+        delta[0] = 0;
+        for (int i = 1; i < CODEC_BLOCK; ++i)
+        {
+            short d = block[i] - block[i - 1];
+            delta[i] = (unsigned short)((d << 1) ^ (d >> 15));
+            max_delta = max<unsigned int>(max_delta, delta[i]);
+        }
+        int b_delta = BitWidth(max_delta);
+
+        bool use_delta = b_delta < b_for;
+        int b = use_delta ? b_delta : b_for;
+        unsigned short ref = use_delta ? block[0] : min_val;
+        if (!use_delta)
+        {
+            for (int i = 0; i < CODEC_BLOCK; ++i)
+            {
+                delta[i] = block[i] - min_val;
+            }
+        }
+
+        out.push_back((use_delta ? 0x80 : 0) | b);
+        out.push_back(ref & 0xff);
+        out.push_back(ref >> 8);
+        if (b > 0)
+        {
+            Pack(delta, b, packed);
+            size_t pos = out.size();
+            out.resize(pos + b * CODEC_LANES * sizeof(unsigned short));
+            memcpy(out.data() + pos, packed, b * CODEC_LANES * sizeof(unsigned short));
+        }
+    }
+
+    return out.size() - start_size;
+}
+
+/*!
+ @brief Decode a waveform.
+
+ @details The encoded bytes are checked while decoding: a block with a bit width larger than 16 or going beyond the end of the input is not decoded.
+
+ @param in The encoded bytes.
+ @param size The number of encoded bytes available.
+ @param n The number of samples of the waveform.
+ @param out The ADC values, must have room for `n` samples.
+ @return size_t The number of bytes read, 0 if the encoded waveform is invalid or truncated.
+ */
+size_t WaveformCodec::Decode(const unsigned char *in, size_t size, size_t n, unsigned short *out)
+{
+    unsigned short block[CODEC_BLOCK];
+    unsigned short packed[CODEC_BLOCK];
+    const unsigned char *p = in;
+    const unsigned char *end = in + size;
+
+    for (size_t start = 0; start < n; start += CODEC_BLOCK)
+    {
+        if (end - p < 3)
+        {
+            return 0;
+        }
+
+        size_t len = min<size_t>(CODEC_BLOCK, n - start);
+        bool use_delta = p[0] & 0x80;
+        int b = p[0] & 0x7f;
+        unsigned short ref = p[1] | (p[2] << 8);
+        p += 3;
+
+        if (b == 0)
+        {
+            fill(out + start, out + start + len, ref);
+            continue;
+        }
+
+        size_t bytes = b * CODEC_LANES * sizeof(unsigned short);
+        if (b > 16 or (size_t)(end - p) < bytes)
+        {
+            return 0;
+        }
+
+        memcpy(packed, p, bytes);
+        p += bytes;
+        Unpack(packed, b, block);
+
+        if (use_delta)
+        {
+            unsigned short val = ref;
+            for (size_t i = 0; i < len; ++i)
+            {
+                val += (unsigned short)((block[i] >> 1) ^ -(block[i] & 1));
+                out[start + i] = val;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < len; ++i)
+            {
+                out[start + i] = block[i] + ref;
+            }
+        }
+    }
+
+    return p - in;
+}
+
+/*!
+ @brief The maximum number of bytes needed to encode a waveform.
+
+ @param n The number of samples.
+ @return size_t
+ */
+size_t WaveformCodec::MaxEncodedSize(size_t n)
+{
+    size_t blocks = (n + CODEC_BLOCK - 1) / CODEC_BLOCK;
+    return blocks * (3 + CODEC_BLOCK * sizeof(unsigned short));
+}
+
+/*!
+ @brief Pack a block of residuals with a given bit width.
+
+ @details The value `i` of the block goes in the lane `i % CODEC_LANES`, each lane is a stream of `b` words of 16 bits.
+ The word `w` of lane `l` is stored at `out[w * CODEC_LANES + l]`.
+
+ @param in The @ref CODEC_BLOCK residuals.
+ @param b The bit width, from 1 to 16.
+ @param out The packed words, `b * CODEC_LANES` of them.
+ */
+void WaveformCodec::Pack(const unsigned short *in, int b, unsigned short *out)
+{
+    unsigned short acc[CODEC_LANES] = {0};
+    int shift = 0;
+
+    for (int v = 0; v < CODEC_BLOCK / CODEC_LANES; ++v)
+    {
+        const unsigned short *val = in + v * CODEC_LANES;
+        for (int l = 0; l < CODEC_LANES; ++l)
+        {
+            acc[l] |= val[l] << shift;
+        }
+        shift += b;
+
+        if (shift >= 16)
+        {
+            shift -= 16;
+            for (int l = 0; l < CODEC_LANES; ++l)
+            {
+                out[l] = acc[l];
+                acc[l] = shift > 0 ? val[l] >> (b - shift) : 0;
+            }
+            out += CODEC_LANES;
+        }
+    }
+}
+
+/*!
+ @brief Unpack a block of residuals packed by @ref WaveformCodec::Pack().
+
+ @param in The packed words.
+ @param b The bit width, from 1 to 16.
+ @param out The @ref CODEC_BLOCK residuals.
+ */
+void WaveformCodec::Unpack(const unsigned short *in, int b, unsigned short *out)
+{
+    const unsigned short mask = (1u << b) - 1;
+    int shift = 0;
+
+    for (int v = 0; v < CODEC_BLOCK / CODEC_LANES; ++v)
+    {
+        unsigned short *val = out + v * CODEC_LANES;
+        if (shift + b > 16)
+        {
+            for (int l = 0; l < CODEC_LANES; ++l)
+            {
+                val[l] = ((in[l] >> shift) | (in[l + CODEC_LANES] << (16 - shift))) & mask;
+            }
+        }
+        else
+        {
+            for (int l = 0; l < CODEC_LANES; ++l)
+            {
+                val[l] = (in[l] >> shift) & mask;
+            }
+        }
+        shift += b;
+
+        if (shift >= 16)
+        {
+            shift -= 16;
+            in += CODEC_LANES;
+        }
+    }
+}
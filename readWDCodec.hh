@@ -0,0 +1,52 @@
+/*!
+ @file readWDCodec.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the lossless codec for 16-bit waveforms.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDCODEC_H
+#define READWDCODEC_H
+
+#include <cstddef>
+#include <vector>
+
+#define CODEC_BLOCK 256 ///< Number of samples packed together with the same bit width.
+#define CODEC_LANES 16  ///< Number of 16-bit lanes in which a block is packed.
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Lossless codec for the 16-bit ADC values of DRS/WDB waveforms.
+
+ @details The waveform is split in blocks of @ref CODEC_BLOCK samples. For each block the better of two predictors is chosen:
+    1. *frame of reference*: the minimum of the block is subtracted from each sample, best for noise-dominated baselines;
+    2. *delta*: the difference between consecutive samples, zigzag encoded, best for smooth slopes.
+
+ The residuals of a block are then bit-packed with the smallest bit width able to hold them. The packing is *vertical*: the block is seen as
+ @ref CODEC_LANES interleaved lanes and the same shift is applied to all the lanes at each step, so that the loops of @ref WaveformCodec::Pack()
+ and @ref WaveformCodec::Unpack() are vectorised by the compiler.
+
+ Each block is stored as one byte with predictor and bit width, the reference value as `uint16` and the packed residuals.
+ */
+class WaveformCodec
+{
+public:
+    static size_t Encode(const unsigned short *, size_t, std::vector<unsigned char> &);
+    static size_t Decode(const unsigned char *, size_t, size_t, unsigned short *);
+    static size_t MaxEncodedSize(size_t);
+
+private:
+    static void Pack(const unsigned short *, int, unsigned short *);
+    static void Unpack(const unsigned short *, int, unsigned short *);
+};
+
+#endif
@@ -0,0 +1,193 @@
+/*!
+ @file readWDCorrelation.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the estimation of the delays between channels by cross-correlation.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDCorrelation.hh"
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : DelayEstimator                                                │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new DelayEstimator object.
+
+ @details The grid of @ref WaveformResampler is used, only the channels in the pairs are resampled. By default any delay shorter than the grid is
+ searched, see @ref DelayEstimator::SetMaxDelay().
+
+ @param times The map of \f$ \Delta t\f$ of the ```TIME``` block.
+ @param n_samples The number of samples of the waveforms.
+ @param pairs The pairs of channels, as board and channel indices.
+ @param period The period of the grid in seconds, 0 for the mean \f$ \Delta t\f$ of the channels.
+ */
+DelayEstimator::DelayEstimator(const MAP &times, int n_samples, const vector<PAIR> &pairs, float period)
+    : times_(DelayEstimator::Select(times, pairs)),
+      pairs_(pairs),
+      period_(period > 0 ? period : DelayEstimator::MeanPeriod(times_)),
+      resampler_(times_, n_samples, period_, WaveformResampler::Interpolation::Cubic),
+      plan_(FFTPlan::Get(FFTPlan::Size(2 * resampler_.GetTimes().size())))
+{
+    for (auto &[first, second] : pairs_)
+    {
+        int i = find(channels_.begin(), channels_.end(), first) - channels_.begin();
+        if (i == (int)channels_.size())
+        {
+            channels_.push_back(first);
+        }
+        int j = find(channels_.begin(), channels_.end(), second) - channels_.begin();
+        if (j == (int)channels_.size())
+        {
+            channels_.push_back(second);
+        }
+        index_.push_back({i, j});
+    }
+
+    spectra_.assign(channels_.size(), vector<complex<float>>(plan_.GetNBins()));
+    energy_.assign(channels_.size(), 0);
+    buffer_.assign(plan_.GetSize(), 0);
+    cross_.resize(plan_.GetNBins());
+    delays_.assign(pairs_.size(), 0);
+    coeff_.assign(pairs_.size(), 0);
+    max_lag_ = resampler_.GetTimes().size() - 2;
+}
+
+/*!
+ @brief Select the channels of the pairs from the map of the ```TIME``` block.
+
+ @param times The map of \f$ \Delta t\f$.
+ @param pairs The pairs of channels.
+ @return MAP
+ */
+DelayEstimator::MAP DelayEstimator::Select(const MAP &times, const vector<PAIR> &pairs)
+{
+    if (pairs.empty())
+    {
+        cerr << "!! Error: no pairs of channels given" << endl;
+        exit(0);
+    }
+
+    MAP selected;
+    for (auto &pair : pairs)
+    {
+        for (auto &[b, c] : {pair.first, pair.second})
+        {
+            if (times.find(b) == times.end() or times.at(b).find(c) == times.at(b).end())
+            {
+                cerr << "!! Error : Couldn't find board-channel of ID (" << b << ", " << c << ")" << endl;
+                exit(0);
+            }
+            selected[b][c] = times.at(b).at(c);
+        }
+    }
+    return selected;
+}
+
+/*!
+ @brief Evaluate the mean \f$ \Delta t\f$ of the channels.
+
+ @param times The map of \f$ \Delta t\f$.
+ @return float
+ */
+float DelayEstimator::MeanPeriod(const MAP &times)
+{
+    double sum = 0;
+    size_t cells = 0;
+    for (auto &[bKey, bVal] : times)
+    {
+        for (auto &[cKey, dt] : bVal)
+        {
+            sum += accumulate(dt.begin(), dt.end(), 0.);
+            cells += dt.size();
+        }
+    }
+    return sum / cells;
+}
+
+/*!
+ @brief Set the largest delay searched.
+
+ @details Limiting the search to the expected delays avoids that a noise peak far from the pulse is taken as the maximum of the correlation.
+
+ @param delay The largest delay in seconds, in both directions.
+ @return DelayEstimator&
+ */
+DelayEstimator &DelayEstimator::SetMaxDelay(float delay)
+{
+    if (delay <= 0)
+    {
+        cerr << "!! Error: the largest delay must be positive, passed value is " << delay << endl;
+        exit(0);
+    }
+
+    max_lag_ = min((int)ceil(delay / period_), (int)resampler_.GetTimes().size() - 2);
+    return *this;
+}
+
+/*!
+ @brief Evaluate the delays of all the pairs of an event.
+
+ @param event The event.
+ @return const vector<float>& The delay of each pair in seconds, in the order of the pairs. See also @ref DelayEstimator::GetCorrelations().
+ */
+const vector<float> &DelayEstimator::Evaluate(DAQEvent &event)
+{
+    int n = plan_.GetSize();
+    for (size_t i = 0; i < channels_.size(); ++i)
+    {
+        auto &volts = resampler_.Resample(event, channels_[i].first, channels_[i].second);
+        int m = volts.size();
+        float mean = accumulate(volts.begin(), volts.end(), 0.f) / m;
+        double energy = 0;
+        for (int k = 0; k < m; ++k)
+        {
+            buffer_[k] = volts[k] - mean;
+            energy += buffer_[k] * buffer_[k];
+        }
+        fill(buffer_.begin() + m, buffer_.end(), 0.f);
+        energy_[i] = energy;
+        plan_.Forward(buffer_.data(), spectra_[i].data());
+    }
+
+    for (size_t p = 0; p < pairs_.size(); ++p)
+    {
+        // conj(A) B, whose inverse is the correlation sum_j a[j] b[j + lag], with the negative lags at the end
+        const float *a = reinterpret_cast<const float *>(spectra_[index_[p].first].data());
+        const float *b = reinterpret_cast<const float *>(spectra_[index_[p].second].data());
+        float *x = reinterpret_cast<float *>(cross_.data());
+        for (int k = 0; k < plan_.GetNBins(); ++k)
+        {
+            x[2 * k] = a[2 * k] * b[2 * k] + a[2 * k + 1] * b[2 * k + 1];
+            x[2 * k + 1] = a[2 * k] * b[2 * k + 1] - a[2 * k + 1] * b[2 * k];
+        }
+        plan_.Inverse(cross_.data(), buffer_.data());
+
+        // Positive lags from the start of the buffer, negative ones from its end
+        const float *corr = buffer_.data();
+        int best = max_element(corr, corr + max_lag_ + 1) - corr;
+        int neg = max_element(corr + n - max_lag_, corr + n) - corr;
+        if (corr[neg] > corr[best])
+        {
+            best = neg - n;
+        }
+
+        float c0 = buffer_[(best + n) % n];
+        float cm = buffer_[(best - 1 + n) % n];
+        float cp = buffer_[(best + 1 + n) % n];
+        float den = cm - 2 * c0 + cp;
+        float shift = den < 0 ? 0.5f * (cm - cp) / den : 0;
+
+        double norm = sqrt(energy_[index_[p].first] * energy_[index_[p].second]);
+        delays_[p] = (best + shift) * period_;
+        coeff_[p] = norm > 0 ? c0 / norm : 0;
+    }
+    return delays_;
+}
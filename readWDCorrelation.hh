@@ -0,0 +1,93 @@
+/*!
+ @file readWDCorrelation.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the estimation of the delays between channels by cross-correlation.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDCORRELATION_H
+#define READWDCORRELATION_H
+
+#include "readWDResample.hh"
+#include "readWDSpectrum.hh"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Class to estimate the delays between pairs of channels of an event by cross-correlation.
+
+ @details The delay of the second channel of a pair with respect to the first one is the lag that maximises the cross-correlation of the two
+ waveforms: the whole pulse is used, not only the samples around a threshold as with @ref DAQEvent::GetTimeCF(). For each event:
+    -# every channel in the pairs is resampled on a common uniform grid with cubic interpolation, see @ref WaveformResampler, so that the
+       correlation is not biased by the different \f$ \Delta t\f$ of the channels;
+    -# the mean is subtracted, the waveform is padded with zeros to twice its length and transformed, see @ref FFTPlan. A channel in many pairs
+       is transformed once;
+    -# for each pair the cross-correlation is the inverse transform of the product of the two spectra, its maximum is found and refined between
+       the grid points with a parabola through the three largest values.
+
+ The delay is given in seconds, positive if the pulse of the second channel comes later. Together with the delay the correlation coefficient at the
+ maximum is given, from -1 to 1, to reject the events without a pulse in one of the channels. The instance is not shared between threads.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+ DelayEstimator delays(file, {{{0, 0}, {0, 1}}, {{0, 0}, {0, 2}}}); // Channels 1 and 2 with respect to channel 0
+
+ while (file >> event)
+ {
+     auto &d = delays.Evaluate(event); // d[0] for the first pair, d[1] for the second
+ }
+ @endcode
+ */
+class DelayEstimator
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>;     ///< Alias for data structure.
+    using PAIR = std::pair<std::pair<int, int>, std::pair<int, int>>; ///< Alias for a pair of board-channel.
+
+public:
+    DelayEstimator(const MAP &, int, const std::vector<PAIR> &, float = 0);
+    /*!
+     @brief Construct a new DelayEstimator object for the channels of a file.
+
+     @param file The file, its ```TIME``` block and its number of samples are used.
+     @param pairs The pairs of channels.
+     @param period The period of the grid in seconds, 0 for the mean \f$ \Delta t\f$ of the channels.
+     */
+    DelayEstimator(DAQFile &file, const std::vector<PAIR> &pairs, float period = 0) : DelayEstimator(file.GetTimeMap(), file.GetNSamples(), pairs, period) {}
+
+    DelayEstimator &SetMaxDelay(float);
+    const std::vector<float> &Evaluate(DAQEvent &);
+
+    const std::vector<PAIR> &GetPairs() { return pairs_; };
+    const std::vector<float> &GetDelays() { return delays_; };
+    const std::vector<float> &GetCorrelations() { return coeff_; };
+
+private:
+    static MAP Select(const MAP &, const std::vector<PAIR> &);
+    static float MeanPeriod(const MAP &);
+
+    MAP times_;                                             ///< The \f$ \Delta t\f$ of the channels in the pairs
+    std::vector<PAIR> pairs_;                               ///< The pairs of channels
+    float period_;                                          ///< Period of the grid, in seconds
+    WaveformResampler resampler_;                           ///< Resampler on the common grid
+    const FFTPlan &plan_;                                   ///< The plan of the transforms, twice as long as the grid
+    std::vector<std::pair<int, int>> channels_;             ///< The channels in the pairs, each one once
+    std::vector<std::pair<int, int>> index_;                ///< For each pair, the index of its channels in @ref DelayEstimator::channels_
+    std::vector<std::vector<std::complex<float>>> spectra_; ///< The spectrum of each channel
+    std::vector<double> energy_;                            ///< The sum of the squares of each channel, to normalise the correlation
+    std::vector<float> buffer_;                             ///< The padded waveform, then the cross-correlation
+    std::vector<std::complex<float>> cross_;                ///< The cross spectrum
+    int max_lag_;                                           ///< The largest lag searched, in grid points
+    std::vector<float> delays_;                             ///< The delay of each pair, in seconds
+    std::vector<float> coeff_;                              ///< The correlation coefficient of each pair
+};
+
+#endif
@@ -0,0 +1,339 @@
+/*!
+ @file readWDDataset.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the multi-file dataset.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDDataset.hh"
+
+#include <atomic>
+#include <deque>
+#include <glob.h>
+#include <thread>
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : DAQDataset                                                    │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new DAQDataset::DAQDataset object from a list of files.
+
+ @param fnames The names of the files, read in the given order.
+ */
+DAQDataset::DAQDataset(const vector<string> &fnames)
+{
+    (*this).Initialise(fnames);
+}
+
+/*!
+ @brief Construct a new DAQDataset::DAQDataset object from a glob pattern.
+
+ @param pattern The pattern, e.g. `path/to/run*.dat`. The files are sorted by name.
+ */
+DAQDataset::DAQDataset(const string &pattern)
+{
+    vector<string> fnames;
+    glob_t g;
+    if (glob(pattern.c_str(), 0, nullptr, &g) == 0)
+    {
+        for (size_t i = 0; i < g.gl_pathc; ++i)
+        {
+            fnames.push_back(g.gl_pathv[i]);
+        }
+    }
+    globfree(&g);
+
+    (*this).Initialise(fnames);
+}
+
+/*!
+ @brief Initialise every file to know its type and its number of events.
+
+ @details The events of all the files are read with the configuration of the first one (see @ref DAQEvent::MakeConfig()), so every file must have
+ the same type, the same boards and channels and the same number of samples of the waveforms: a different file exits with an error.
+
+ @param fnames The names of the files.
+ @return DAQDataset&
+ */
+DAQDataset &DAQDataset::Initialise(const vector<string> &fnames)
+{
+    n_events_ = 0;
+    file_idx_ = -1;
+    evt_ = -1;
+    local_evt_ = -1;
+
+    if (fnames.empty())
+    {
+        cerr << "!! Error: no files given to DAQDataset" << endl;
+        exit(0);
+    }
+
+    vector<pair<int, int>> channels; // The boards and channels of the first file, all the events are read with its configuration
+    for (auto &fname : fnames)
+    {
+        DAQFile file(fname);
+        if (file.GetType().empty())
+        {
+            cerr << "!! Error: unable to initialise file " << fname << ", skipped" << endl;
+            continue;
+        }
+
+        if (type_.empty())
+        {
+            type_ = file.GetType();
+        }
+        else if (type_ != file.GetType())
+        {
+            cerr << "!! Error: file " << fname << " is of type " << file.GetType() << ", expected " << type_ << endl;
+            exit(0);
+        }
+
+        vector<pair<int, int>> file_channels;
+        for (auto &[bKey, bVal] : file.GetTimeMap())
+        {
+            for (auto &[cKey, cVal] : bVal)
+            {
+                file_channels.push_back({bKey, cKey});
+            }
+        }
+        if (files_.empty())
+        {
+            channels = file_channels;
+        }
+        else if (file_channels != channels)
+        {
+            cerr << "!! Error: file " << fname << " has " << file_channels.size() << " channels in " << file.GetTimeMap().size() << " boards, expected the "
+                 << channels.size() << " channels of " << files_[0].name << endl;
+            exit(0);
+        }
+        else if (file.GetNSamples() != files_[0].n_samples)
+        {
+            cerr << "!! Error: file " << fname << " has waveforms of " << file.GetNSamples() << " samples, expected " << files_[0].n_samples << endl;
+            exit(0);
+        }
+
+        DAQFileInfo info;
+        info.name = fname;
+        info.type = file.GetType();
+        info.n_events = file.GetNEvents();
+        info.first_event = n_events_;
+        info.n_samples = file.GetNSamples();
+        info.board_serials = file.GetBoardSerials();
+        files_.push_back(info);
+        n_events_ += info.n_events;
+    }
+
+    cout << "DAQDataset: " << files_.size() << " files, " << n_events_ << " events" << endl;
+    return *this;
+}
+
+/*!
+ @brief Getter method read-only for the informations about a file.
+
+ @param i The index of the file.
+ @return const DAQFileInfo&
+ */
+const DAQFileInfo &DAQDataset::GetFileInfo(int i)
+{
+    if (i < 0 or i >= (int)files_.size())
+    {
+        cerr << "!! Error: invalid file index, max index is " << files_.size() - 1 << endl;
+        exit(0);
+    }
+    return files_[i];
+}
+
+/*!
+ @brief Read into a @ref DRSEvent the next event of the dataset.
+
+ @param event
+ @return true
+ @return false
+ */
+bool DAQDataset::operator>>(DRSEvent &event) // DAQDataset >> DRSEvent
+{
+    return (*this).Read(event);
+}
+
+/*!
+ @brief Read into a @ref WDBEvent the next event of the dataset.
+
+ @param event
+ @return true
+ @return false
+ */
+bool DAQDataset::operator>>(WDBEvent &event) // DAQDataset >> WDBEvent
+{
+    return (*this).Read(event);
+}
+
+/*!
+ @brief Read the next event, opening the next file when the current one is finished.
+
+ @param event The event, a @ref DRSEvent or a @ref WDBEvent.
+ @return true
+ @return false
+ */
+template <typename T>
+bool DAQDataset::Read(T &event)
+{
+    while (true)
+    {
+        if (file_ and local_evt_ + 1 < files_[file_idx_].n_events and *file_ >> event)
+        {
+            ++local_evt_;
+            evt_ = files_[file_idx_].first_event + local_evt_;
+            return 1;
+        }
+
+        if (file_idx_ + 1 >= (int)files_.size())
+        {
+            file_.reset();
+            return 0;
+        }
+
+        ++file_idx_;
+        local_evt_ = -1;
+        file_ = make_unique<DAQFile>(files_[file_idx_].name);
+    }
+}
+
+/*!
+ @brief Method to reset the dataset, the next event read is the first event of the first file.
+
+ @return DAQDataset&
+ */
+DAQDataset &DAQDataset::Reset()
+{
+    file_.reset();
+    file_idx_ = -1;
+    evt_ = -1;
+    local_evt_ = -1;
+    return *this;
+}
+
+/*!
+ @brief Process all the events of a DRS dataset in parallel.
+
+ @param func The function called for each event with the event, its global number and the index of the thread.
+ @param n_threads The number of threads, 0 to use all the available cores.
+ @return DAQDataset&
+ */
+DAQDataset &DAQDataset::Process(const function<void(DRSEvent &, long, unsigned int)> &func, unsigned int n_threads)
+{
+    return (*this).ProcessImpl(func, n_threads);
+}
+
+/*!
+ @brief Process all the events of a WDB dataset in parallel.
+
+ @param func The function called for each event with the event, its global number and the index of the thread.
+ @param n_threads The number of threads, 0 to use all the available cores.
+ @return DAQDataset&
+ */
+DAQDataset &DAQDataset::Process(const function<void(WDBEvent &, long, unsigned int)> &func, unsigned int n_threads)
+{
+    return (*this).ProcessImpl(func, n_threads);
+}
+
+/*!
+ @brief Schedule the files on a pool of threads with work stealing.
+
+ @details The files are sorted from the largest to the smallest and dealt to the threads in turn. Each thread takes the files from the front of its
+ own queue, when the queue is empty it steals from the back of the queue of another thread, so that the largest files are started first and the
+ smallest ones fill the gaps at the end. The function is called concurrently by different threads: it must only touch data owned by its thread.
+
+ @param func The function called for each event.
+ @param n_threads The number of threads.
+ @return DAQDataset&
+ */
+template <typename T>
+DAQDataset &DAQDataset::ProcessImpl(const function<void(T &, long, unsigned int)> &func, unsigned int n_threads)
+{
+    if (type_ != T::type_)
+    {
+        cerr << "!! Error: Invalid type of class used" << endl
+             << "Type expected: " << type_ << endl
+             << "Event given: " << T::type_ << endl;
+        exit(0);
+    }
+
+    if (n_threads == 0)
+    {
+        n_threads = max(1u, thread::hardware_concurrency());
+    }
+    n_threads = min<unsigned int>(n_threads, files_.size());
+
+    vector<int> order(files_.size());
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [this](int a, int b)
+                { return files_[a].n_events > files_[b].n_events; });
+
+    vector<deque<int>> queues(n_threads);
+    vector<mutex> mutexes(n_threads);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        queues[i % n_threads].push_back(order[i]);
+    }
+
+    auto next = [&](unsigned int t) -> int
+    {
+        {
+            lock_guard<mutex> lock(mutexes[t]);
+            if (!queues[t].empty())
+            {
+                int f = queues[t].front();
+                queues[t].pop_front();
+                return f;
+            }
+        }
+        for (unsigned int k = 1; k < n_threads; ++k)
+        {
+            unsigned int v = (t + k) % n_threads;
+            lock_guard<mutex> lock(mutexes[v]);
+            if (!queues[v].empty())
+            {
+                int f = queues[v].back();
+                queues[v].pop_back();
+                return f;
+            }
+        }
+        return -1;
+    };
+
+    auto worker = [&](unsigned int t)
+    {
+        T event;
+        for (int f = next(t); f >= 0; f = next(t))
+        {
+            DAQFile file(files_[f].name);
+            long evt = files_[f].first_event;
+            long last = files_[f].first_event + files_[f].n_events;
+            while (evt < last and file >> event)
+            {
+                func(event, evt, t);
+                ++evt;
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (unsigned int t = 0; t < n_threads; ++t)
+    {
+        threads.emplace_back(worker, t);
+    }
+    for (auto &th : threads)
+    {
+        th.join();
+    }
+
+    return *this;
+}
@@ -0,0 +1,108 @@
+/*!
+ @file readWDDataset.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the multi-file dataset.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDDATASET_H
+#define READWDDATASET_H
+
+#include "readWD.hh"
+
+#include <functional>
+#include <memory>
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Informations about one file of a @ref DAQDataset.
+ */
+struct DAQFileInfo
+{
+    std::string name;                         ///< The name of the file.
+    std::string type;                         ///< The type of board, "DRS" or "WDB".
+    long n_events;                            ///< The number of events in the file.
+    long first_event;                         ///< The global number of the first event of the file.
+    int n_samples;                            ///< The number of samples of the waveforms.
+    std::vector<unsigned short> board_serials; ///< The serial numbers of the boards.
+};
+
+/*!
+ @brief Class to read many files as one stream of events.
+
+ @details The files are given as a list or as a glob pattern. When the dataset is built every file is initialised once to know its type and its number
+ of events, so that each event gets a global number. The dataset can be read sequentially, as a @ref DAQFile:
+
+ @code{.cpp}
+ DAQDataset dataset("path/to/run*.dat");
+ DRSEvent event;
+
+ while (dataset >> event)
+ {
+     float charge = event.GetChannel(0, 0).GetCharge();
+     // ...
+ }
+ @endcode
+
+ or in parallel with @ref DAQDataset::Process(): the files are scheduled on a pool of threads, each thread reads whole files with its own @ref DAQFile
+ and @ref DAQEvent. The files are initially distributed from the largest to the smallest, then a thread that has finished its files steals
+ the files still waiting in the queue of another thread.
+
+ @code{.cpp}
+ vector<TH1F> h(n_threads, TH1F("h", "charge", 100, 0, 10));
+ dataset.Process([&](DRSEvent &event, long evt, unsigned int thread)
+                 { h[thread].Fill(event.GetChannel(0, 0).GetCharge()); }, n_threads);
+ @endcode
+ */
+class DAQDataset
+{
+public:
+    DAQDataset(const std::vector<std::string> &);
+    DAQDataset(const std::string &);
+    /*!
+     @brief Construct a new DAQDataset object from a list of files written in braces.
+
+     @param fnames The names of the files.
+     */
+    DAQDataset(std::initializer_list<std::string> fnames) : DAQDataset(std::vector<std::string>(fnames)) {}
+
+    bool operator>>(DRSEvent &);
+    bool operator>>(WDBEvent &);
+    DAQDataset &Reset();
+
+    DAQDataset &Process(const std::function<void(DRSEvent &, long, unsigned int)> &, unsigned int = 0);
+    DAQDataset &Process(const std::function<void(WDBEvent &, long, unsigned int)> &, unsigned int = 0);
+
+    long GetNEvents() { return n_events_; };
+    long GetEventNumber() { return evt_; };
+    int GetFileIndex() { return file_idx_; };
+    size_t GetNFiles() { return files_.size(); };
+    const DAQFileInfo &GetFileInfo(int);
+
+private:
+    DAQDataset &Initialise(const std::vector<std::string> &);
+
+    template <typename T>
+    bool Read(T &);
+    template <typename T>
+    DAQDataset &ProcessImpl(const std::function<void(T &, long, unsigned int)> &, unsigned int);
+
+    std::vector<DAQFileInfo> files_; ///< Informations about each file.
+    std::string type_;               ///< The type of board, the same for all the files.
+    long n_events_;                  ///< The total number of events.
+    std::unique_ptr<DAQFile> file_;  ///< The file currently read in sequential mode.
+    int file_idx_;                   ///< Index of the file currently read, -1 before the first.
+    long evt_;                       ///< Global number of the last event read, -1 before the first.
+    long local_evt_;                 ///< Number of the last event read in the current file.
+};
+
+#endif
@@ -0,0 +1,408 @@
+/*!
+ @file readWDFilter.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the digital filters applied to the waveforms.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDSpectrum.hh"
+
+using namespace std;
+
+static const int STAGE_FIR = 0;      ///< Stage with feed-forward coefficients only.
+static const int STAGE_IIR = 1;      ///< Stage with feed-forward and feedback coefficients.
+static const int STAGE_RESTORER = 2; ///< Baseline restorer with a threshold.
+static const int STAGE_BANDSTOP = 3; ///< Band of frequencies removed from the transform.
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : WaveformFilter                                                │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Build a centred moving average.
+
+ @details Each sample is replaced by the mean of the `n` samples around it. With an even `n` the window has one more sample after than before.
+
+ @param n The number of samples averaged.
+ @return WaveformFilter
+ */
+WaveformFilter WaveformFilter::MovingAverage(int n)
+{
+    if (n < 1)
+    {
+        cerr << "!! Error: the moving average needs at least 1 sample, passed value is " << n << endl;
+        exit(0);
+    }
+    return WaveformFilter::FIR(vector<float>(n, 1.f / n), n / 2);
+}
+
+/*!
+ @brief Build a \f$ CR-RC^n \f$ shaper.
+
+ @details Each stage is the discretisation of the analog one with the same time constant \f$ \tau \f$, with \f$ a = e^{-1/\tau} \f$:
+    - CR: \f$ y_i = a (y_{i-1} + x_i - x_{i-1}) \f$
+    - RC: \f$ y_i = a y_{i-1} + (1 - a) x_i \f$
+
+ The baseline of the output is 0, the peak of the output is delayed by about \f$ n \tau \f$.
+
+ @param tau The time constant, in samples.
+ @param n The number of integrations.
+ @return WaveformFilter
+ */
+WaveformFilter WaveformFilter::CRRC(float tau, int n)
+{
+    if (tau <= 0 or n < 0)
+    {
+        cerr << "!! Error: invalid CR-RC shaper, time constant must be positive and order must not be negative" << endl;
+        exit(0);
+    }
+
+    float a = exp(-1 / tau);
+    WaveformFilter filter = WaveformFilter::IIR({a, -a}, {1, -a});
+    for (int k = 0; k < n; ++k)
+    {
+        filter.Add(WaveformFilter::IIR({1 - a}, {1, -a}));
+    }
+    return filter;
+}
+
+/*!
+ @brief Build a baseline-restoring high-pass.
+
+ @details Without a threshold the filter is the CR stage of @ref WaveformFilter::CRRC(): the baseline is brought to 0, the pulses are followed by an
+ undershoot. With a threshold the baseline is tracked with the time constant \f$ \tau \f$ and subtracted, but it is updated only while the waveform is
+ within the threshold from it: the slow drifts of the baseline are removed and the pulses are left as they are.
+
+ @param tau The time constant, in samples.
+ @param thr The threshold in Volts, 0 for the linear high-pass.
+ @return WaveformFilter
+ */
+WaveformFilter WaveformFilter::HighPass(float tau, float thr)
+{
+    if (tau <= 0 or thr < 0)
+    {
+        cerr << "!! Error: invalid high-pass, time constant must be positive and threshold must not be negative" << endl;
+        exit(0);
+    }
+
+    float a = exp(-1 / tau);
+    if (thr == 0)
+    {
+        return WaveformFilter::IIR({a, -a}, {1, -a});
+    }
+
+    WaveformFilter filter;
+    filter.stages_.push_back({STAGE_RESTORER, 0, thr, {1 - a}, {1, -a}});
+    return filter;
+}
+
+/*!
+ @brief Build a notch filter.
+
+ @details The bins of the Fourier transform within the band are set to 0, the band is widened to at least one bin. The transform is evaluated on the
+ waveform after the line between the first and the last sample is subtracted, then added back: the waveform is continuous at its ends, as the transform
+ assumes, and its baseline is not changed. A waveform that is not a power of two long is padded with zeros. A line that is not at the centre of a bin
+ leaks into the near ones, so the band should be a few bins wide, a bin being \f$ 1/n\f$ with \f$ n\f$ the size of the transform; the residual of the line
+ is larger on the first and last samples.
+
+ @param f The frequency removed, in units of the sampling frequency: a line at 50 MHz sampled at 5 GSPS is at 0.01.
+ @param width The width of the band removed, in the same units.
+ @return WaveformFilter
+ */
+WaveformFilter WaveformFilter::Notch(float f, float width)
+{
+    if (f < 0 or f > 0.5 or width < 0)
+    {
+        cerr << "!! Error: invalid notch filter, frequency must be between 0 and 0.5 and width must not be negative" << endl;
+        exit(0);
+    }
+
+    WaveformFilter filter;
+    filter.stages_.push_back({STAGE_BANDSTOP, 0, 0, {f - width / 2, f + width / 2}, {1}});
+    return filter;
+}
+
+/*!
+ @brief Build a low-pass filter.
+
+ @details The bins of the Fourier transform above the cut are set to 0, as in @ref WaveformFilter::Notch().
+
+ @param f The frequency of the cut, in units of the sampling frequency.
+ @return WaveformFilter
+ */
+WaveformFilter WaveformFilter::LowPass(float f)
+{
+    if (f <= 0 or f > 0.5)
+    {
+        cerr << "!! Error: invalid low-pass filter, frequency must be between 0 and 0.5, passed value is " << f << endl;
+        exit(0);
+    }
+
+    WaveformFilter filter;
+    filter.stages_.push_back({STAGE_BANDSTOP, 0, 0, {f, 0.5}, {1}});
+    return filter;
+}
+
+/*!
+ @brief Build a generic FIR filter.
+
+ @details The output is \f$ y_i = \sum_k b_k x_{i - k + offset} \f$, with the offset the taps can be centred on the sample, so that the pulses are not shifted.
+
+ @param b The coefficients.
+ @param offset The number of samples the output is advanced, from 0 (causal filter) to the number of coefficients minus 1.
+ @return WaveformFilter
+ */
+WaveformFilter WaveformFilter::FIR(const vector<float> &b, int offset)
+{
+    if (b.empty() or offset < 0 or offset >= (int)b.size())
+    {
+        cerr << "!! Error: invalid FIR filter, " << b.size() << " coefficients with offset " << offset << endl;
+        exit(0);
+    }
+
+    WaveformFilter filter;
+    filter.stages_.push_back({STAGE_FIR, offset, 0, b, {1}});
+    return filter;
+}
+
+/*!
+ @brief Build a generic IIR filter.
+
+ @details The output is given by \f$ \sum_k a_k y_{i - k} = \sum_k b_k x_{i - k} \f$, the coefficients are normalised so that \f$ a_0 = 1 \f$.
+
+ @param b The feed-forward coefficients.
+ @param a The feedback coefficients.
+ @return WaveformFilter
+ */
+WaveformFilter WaveformFilter::IIR(const vector<float> &b, const vector<float> &a)
+{
+    if (b.empty() or a.empty() or a[0] == 0)
+    {
+        cerr << "!! Error: invalid IIR filter, the coefficients must not be empty and a[0] must not be 0" << endl;
+        exit(0);
+    }
+
+    Stage stage = {STAGE_IIR, 0, 0, b, a};
+    for (auto &c : stage.b)
+    {
+        c /= a[0];
+    }
+    for (auto &c : stage.a)
+    {
+        c /= a[0];
+    }
+
+    WaveformFilter filter;
+    filter.stages_.push_back(stage);
+    return filter;
+}
+
+/*!
+ @brief Chain another filter after this one.
+
+ @param filter The filter, its stages are applied after the ones of this filter.
+ @return WaveformFilter&
+ */
+WaveformFilter &WaveformFilter::Add(const WaveformFilter &filter)
+{
+    stages_.insert(stages_.end(), filter.stages_.begin(), filter.stages_.end());
+    return *this;
+}
+
+/*!
+ @brief Apply the filter in place.
+
+ @param v The waveform.
+ @param n The number of samples.
+ @param work A buffer used by the filters, resized if needed.
+ */
+void WaveformFilter::Apply(float *v, int n, vector<float> &work) const
+{
+    if (n < 1)
+    {
+        return;
+    }
+
+    for (auto &stage : stages_)
+    {
+        if (stage.type == STAGE_FIR)
+        {
+            WaveformFilter::ApplyFIR(stage, v, n, work);
+        }
+        else if (stage.type == STAGE_IIR)
+        {
+            WaveformFilter::ApplyIIR(stage, v, n, work);
+        }
+        else if (stage.type == STAGE_RESTORER)
+        {
+            WaveformFilter::ApplyRestorer(stage, v, n);
+        }
+        else
+        {
+            WaveformFilter::ApplyBandStop(stage, v, n, work);
+        }
+    }
+}
+
+/*!
+ @brief Apply the feed-forward coefficients of a stage.
+
+ @details The waveform is copied in the buffer, padded at both ends with the first and the last sample, then the taps are added one at a time to the output.
+
+ @param stage The stage.
+ @param v The waveform.
+ @param n The number of samples.
+ @param work The buffer.
+ */
+void WaveformFilter::ApplyFIR(const Stage &stage, float *v, int n, vector<float> &work)
+{
+    int taps = stage.b.size();
+    int left = taps - 1 - stage.offset;
+    work.resize(n + taps - 1);
+    fill(work.begin(), work.begin() + left, v[0]);
+    copy(v, v + n, work.begin() + left);
+    fill(work.begin() + left + n, work.end(), v[n - 1]);
+
+    const float *w = work.data();
+    float b = stage.b[taps - 1];
+    for (int i = 0; i < n; ++i)
+    {
+        v[i] = b * w[i];
+    }
+    for (int k = taps - 2; k >= 0; --k)
+    {
+        b = stage.b[k];
+        const float *wk = w + taps - 1 - k;
+        for (int i = 0; i < n; ++i)
+        {
+            v[i] += b * wk[i];
+        }
+    }
+}
+
+/*!
+ @brief Apply an IIR stage.
+
+ @details The feed-forward part is applied with @ref WaveformFilter::ApplyFIR(), then the feedback. The outputs before the first sample are set to the
+ steady state reached with a constant input equal to the first sample.
+
+ @param stage The stage.
+ @param v The waveform.
+ @param n The number of samples.
+ @param work The buffer.
+ */
+void WaveformFilter::ApplyIIR(const Stage &stage, float *v, int n, vector<float> &work)
+{
+    float sum_b = accumulate(stage.b.begin(), stage.b.end(), 0.f);
+    float sum_a = accumulate(stage.a.begin(), stage.a.end(), 0.f);
+    float y0 = sum_a != 0 ? v[0] * sum_b / sum_a : 0;
+
+    WaveformFilter::ApplyFIR(stage, v, n, work);
+
+    int order = stage.a.size();
+    if (order == 2) // First order, as the CR and RC stages
+    {
+        float a1 = stage.a[1];
+        float y = y0;
+        for (int i = 0; i < n; ++i)
+        {
+            y = v[i] - a1 * y;
+            v[i] = y;
+        }
+        return;
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        float y = v[i];
+        for (int k = 1; k < order; ++k)
+        {
+            y -= stage.a[k] * (i >= k ? v[i - k] : y0);
+        }
+        v[i] = y;
+    }
+}
+
+/*!
+ @brief Apply a baseline restorer with threshold.
+
+ @param stage The stage.
+ @param v The waveform.
+ @param n The number of samples.
+ */
+void WaveformFilter::ApplyRestorer(const Stage &stage, float *v, int n)
+{
+    float k = stage.b[0];
+    float baseline = v[0];
+    for (int i = 0; i < n; ++i)
+    {
+        float d = v[i] - baseline;
+        if (abs(d) < stage.thr)
+        {
+            baseline += k * d;
+        }
+        v[i] = d;
+    }
+}
+
+/*!
+ @brief Remove a band of frequencies.
+
+ @details See @ref WaveformFilter::Notch(). The buffer holds the waveform and its transform.
+
+ @param stage The stage.
+ @param v The waveform.
+ @param n The number of samples.
+ @param work The buffer.
+ */
+void WaveformFilter::ApplyBandStop(const Stage &stage, float *v, int n, vector<float> &work)
+{
+    const FFTPlan &plan = FFTPlan::Get(FFTPlan::Size(n));
+    int size = plan.GetSize();
+    work.resize(size + 2 * plan.GetNBins());
+    float *x = work.data();
+    complex<float> *X = reinterpret_cast<complex<float> *>(work.data() + size);
+
+    float first = v[0];
+    float slope = n > 1 ? (v[n - 1] - v[0]) / (n - 1) : 0;
+    for (int i = 0; i < n; ++i)
+    {
+        x[i] = v[i] - first - slope * i;
+    }
+    fill(x + n, x + size, 0.f);
+
+    plan.Forward(x, X);
+    int lo = max((int)ceil(stage.b[0] * size - 0.5f), 0);
+    int hi = min((int)floor(stage.b[1] * size + 0.5f), size / 2);
+    fill(X + lo, X + max(hi + 1, lo), complex<float>(0, 0));
+    plan.Inverse(X, x);
+
+    for (int i = 0; i < n; ++i)
+    {
+        v[i] = x[i] + first + slope * i;
+    }
+}
+
+/*!
+ @brief Evaluate the hash of the stages, see @ref HashFNV().
+
+ @param hash The hash to be updated.
+ @return unsigned long long
+ */
+unsigned long long WaveformFilter::Hash(unsigned long long hash) const
+{
+    for (auto &stage : stages_)
+    {
+        hash = HashFNV(&stage.type, sizeof(int), hash);
+        hash = HashFNV(&stage.offset, sizeof(int), hash);
+        hash = HashFNV(&stage.thr, sizeof(float), hash);
+        hash = HashFNV(stage.b.data(), stage.b.size() * sizeof(float), hash);
+        hash = HashFNV(stage.a.data(), stage.a.size() * sizeof(float), hash);
+    }
+    return hash;
+}
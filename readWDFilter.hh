@@ -0,0 +1,95 @@
+/*!
+ @file readWDFilter.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the digital filters applied to the waveforms.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDFILTER_H
+#define READWDFILTER_H
+
+#include <vector>
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Chain of digital filters applied in place to a waveform.
+
+ @details A filter is built with one of the static methods and more filters are chained with @ref WaveformFilter::Add(), the stages are applied in
+ the order in which they were added. The filters work on the sample index: the time constants and the lengths are given in samples, the sampling of
+ the DRS4 being uniform within a few percent.
+    - @ref WaveformFilter::MovingAverage(): centred moving average, it does not shift the pulses in time.
+    - @ref WaveformFilter::CRRC(): \f$ CR-RC^n \f$ shaping, a differentiation followed by \f$ n \f$ integrations with the same time constant.
+    - @ref WaveformFilter::HighPass(): baseline-restoring high-pass, the baseline is brought to 0. With a threshold the baseline is followed only while the
+      waveform is close to it, so the pulses are not distorted.
+    - @ref WaveformFilter::Notch() and @ref WaveformFilter::LowPass(): the bins of a band of frequencies are removed from the Fourier transform of the
+      waveform, see @ref FFTPlan. The frequencies are given in units of the sampling frequency, from 0 to 0.5.
+    - @ref WaveformFilter::FIR() and @ref WaveformFilter::IIR(): generic filters given their coefficients.
+
+ Before the first sample the waveform is taken as constant, equal to the first sample, so that the filters start from their steady state and do not ring
+ at the beginning of the waveform. The feed-forward part of every filter is a loop over the taps with an inner loop over the samples, vectorised by the
+ compiler, only the feedback of the IIR filters is evaluated sample by sample.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+
+ event.MakeConfig(file);
+ event.GetChannel(0, 1).SetFilter(WaveformFilter::CRRC(4, 2));    // Only board/channel 0-1
+ event.SetFilter(WaveformFilter::MovingAverage(5));                 // All the channels
+ while (file >> event)
+ {
+     float charge = event.GetChannel(0, 1).GetCharge(); // Evaluated on the filtered waveform
+ }
+ @endcode
+ */
+class WaveformFilter
+{
+public:
+    WaveformFilter() {}
+
+    static WaveformFilter MovingAverage(int);
+    static WaveformFilter CRRC(float, int = 1);
+    static WaveformFilter HighPass(float, float = 0);
+    static WaveformFilter Notch(float, float);
+    static WaveformFilter LowPass(float);
+    static WaveformFilter FIR(const std::vector<float> &, int = 0);
+    static WaveformFilter IIR(const std::vector<float> &, const std::vector<float> &);
+
+    WaveformFilter &Add(const WaveformFilter &);
+    void Apply(float *, int, std::vector<float> &) const;
+
+    bool IsEmpty() const { return stages_.empty(); };
+    size_t GetNStages() const { return stages_.size(); };
+    unsigned long long Hash(unsigned long long) const;
+
+private:
+    /*!
+     @brief One stage of the chain.
+     */
+    struct Stage
+    {
+        int type;             ///< The type of stage, see the static methods.
+        int offset;           ///< Number of samples the output of a FIR stage is advanced, to centre its taps.
+        float thr;            ///< Threshold of the baseline restorer, 0 for a linear high-pass.
+        std::vector<float> b; ///< The feed-forward coefficients, or the band removed by the frequency domain stages.
+        std::vector<float> a; ///< The feedback coefficients, normalised to `a[0] = 1`.
+    };
+
+    static void ApplyFIR(const Stage &, float *, int, std::vector<float> &);
+    static void ApplyIIR(const Stage &, float *, int, std::vector<float> &);
+    static void ApplyRestorer(const Stage &, float *, int);
+    static void ApplyBandStop(const Stage &, float *, int, std::vector<float> &);
+
+    std::vector<Stage> stages_; ///< The stages, applied in order.
+};
+
+#endif
@@ -0,0 +1,234 @@
+/*!
+ @file readWDOffset.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the calibration of the offsets of the cells of the DRS chip.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDOffset.hh"
+#include "readWDAverage.hh"
+
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : OffsetCalibration                                             │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new OffsetCalibration object from a pedestal run.
+
+ @details All the events of the file are read, then the file is reset to its first event. The waveforms must not contain pulses: a pulse adds to the
+ mean of the cells it covers, and the cells covered change with the trigger cell, so the pulses of a run with a random trigger become a bias spread
+ over the whole chip.
+
+ @param file The pedestal run.
+ */
+OffsetCalibration::OffsetCalibration(DAQFile &file)
+{
+    WaveformAverage average(file, WaveformAverage::Alignment::Cell);
+    if (file.GetType() == "WDB")
+    {
+        OffsetCalibration::Accumulate<WDBEvent>(file, average);
+    }
+    else
+    {
+        OffsetCalibration::Accumulate<DRSEvent>(file, average);
+    }
+    file.Reset();
+    *this = OffsetCalibration(average);
+}
+
+/*!
+ @brief Construct a new OffsetCalibration object from the cells averaged over a pedestal run.
+
+ @details To be used when the pedestal run is read in parallel: the partial averages of the threads are merged with @ref WaveformAverage::Merge() and
+ then given to this constructor. The cells never read out (region of interest readout) get a null offset.
+
+ @param average The average of the cells, with the alignment @ref WaveformAverage::Alignment::Cell.
+ */
+OffsetCalibration::OffsetCalibration(WaveformAverage &average)
+{
+    if (average.GetAlignment() != WaveformAverage::Alignment::Cell)
+    {
+        cerr << "!! Error: the offsets need the average of the cells, use WaveformAverage::Alignment::Cell" << endl;
+        exit(0);
+    }
+
+    for (auto &[b, c] : average.GetChannels())
+    {
+        auto mean = average.GetMean(b, c);
+        auto entries = average.GetEntries(b, c);
+        double sum = 0;
+        long filled = 0;
+        for (size_t k = 0; k < mean.size(); ++k)
+        {
+            if (entries[k] > 0)
+            {
+                sum += mean[k];
+                ++filled;
+            }
+        }
+        if (filled == 0)
+        {
+            continue;
+        }
+
+        float level = sum / filled;
+        vector<float> &offsets = offsets_[b][c];
+        offsets.assign(mean.size(), 0);
+        for (size_t k = 0; k < mean.size(); ++k)
+        {
+            if (entries[k] > 0)
+            {
+                offsets[k] = mean[k] - level;
+            }
+        }
+    }
+}
+
+/*!
+ @brief Construct a new OffsetCalibration object from a table written by @ref OffsetCalibration::Write().
+
+ @details Each line contains board, channel, cell and offset in Volts, the lines starting with ```#``` are skipped. The cells of a channel are
+ numbered from 0 to the number of cells minus 1, the cells not listed get a null offset.
+
+ @param fname The name of the file.
+ */
+OffsetCalibration::OffsetCalibration(const string &fname)
+{
+    ifstream in(fname);
+    if (!in.is_open())
+    {
+        cerr << "!! Error: unable to read offset table " << fname << endl;
+        exit(0);
+    }
+
+    string line;
+    while (getline(in, line))
+    {
+        if (line.empty() or line[0] == '#')
+        {
+            continue;
+        }
+
+        istringstream ss(line);
+        int b, c, cell;
+        float offset;
+        if (!(ss >> b >> c >> cell >> offset) or cell < 0)
+        {
+            cerr << "!! Error: invalid line in offset table " << fname << ": " << line << endl;
+            exit(0);
+        }
+
+        vector<float> &offsets = offsets_[b][c];
+        if ((int)offsets.size() <= cell)
+        {
+            offsets.resize(cell + 1, 0);
+        }
+        offsets[cell] = offset;
+    }
+}
+
+/*!
+ @brief Read all the events of a file into an average.
+
+ @tparam T The type of event of the file.
+ @param file The file.
+ @param average The average of the cells.
+ */
+template <typename T>
+void OffsetCalibration::Accumulate(DAQFile &file, WaveformAverage &average)
+{
+    T event;
+    while (file >> event)
+    {
+        average.Add(event);
+    }
+}
+
+/*!
+ @brief Write the table to a text file.
+
+ @param fname The name of the file.
+ @return OffsetCalibration&
+ */
+OffsetCalibration &OffsetCalibration::Write(const string &fname)
+{
+    ofstream o(fname);
+    if (!o.is_open())
+    {
+        cerr << "!! Error: unable to write offset table " << fname << endl;
+        return *this;
+    }
+
+    o << "# board channel cell offset[V]" << endl;
+    o << scientific << setprecision(6);
+    for (auto &[bKey, bVal] : offsets_)
+    {
+        for (auto &[cKey, offsets] : bVal)
+        {
+            for (size_t k = 0; k < offsets.size(); ++k)
+            {
+                o << bKey << " " << cKey << " " << k << " " << offsets[k] << "\n";
+            }
+        }
+    }
+    return *this;
+}
+
+/*!
+ @brief Set the offsets of a channel.
+
+ @param offsets The offset of each cell in Volts.
+ @param b The board.
+ @param c The channel.
+ @return OffsetCalibration&
+ */
+OffsetCalibration &OffsetCalibration::SetOffsets(const vector<float> &offsets, int b, int c)
+{
+    if (offsets.empty())
+    {
+        cerr << "!! Error: no offsets given for board-channel of ID (" << b << ", " << c << ")" << endl;
+        exit(0);
+    }
+    offsets_[b][c] = offsets;
+    return *this;
+}
+
+/*!
+ @brief Check if the table has the offsets of a channel.
+
+ @param b The board.
+ @param c The channel.
+ @return true
+ @return false
+ */
+bool OffsetCalibration::HasOffsets(int b, int c) const
+{
+    return offsets_.find(b) != offsets_.end() and offsets_.at(b).find(c) != offsets_.at(b).end();
+}
+
+/*!
+ @brief Getter method read-only for the offsets of a channel.
+
+ @param b The board.
+ @param c The channel.
+ @return const vector<float>& The offset of each cell in Volts.
+ */
+const vector<float> &OffsetCalibration::GetOffsets(int b, int c) const
+{
+    if (!(*this).HasOffsets(b, c))
+    {
+        cerr << "!! Error : Couldn't find board-channel of ID (" << b << ", " << c << ")" << endl;
+        exit(0);
+    }
+    return offsets_.at(b).at(c);
+}
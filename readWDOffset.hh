@@ -0,0 +1,82 @@
+/*!
+ @file readWDOffset.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the calibration of the offsets of the cells of the DRS chip.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDOFFSET_H
+#define READWDOFFSET_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+class DAQFile;
+class WaveformAverage;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Table of the voltage offsets of the cells of the DRS chip, for each board and channel.
+
+ @details Every cell of the chip stores the voltage with a small offset of its own, which follows the physical cell and not the index of the sample:
+ since the readout starts from the trigger cell, the offsets move along the waveform from one event to the other and look like noise. The offsets are
+ measured on a pedestal run, without pulses: the samples are mapped back to their cells with the trigger cell and averaged, see
+ @ref WaveformAverage::Alignment::Cell. The offset of a cell is its mean minus the mean of all the cells of the channel, so that the correction removes
+ the pattern of the cells without moving the baseline.
+
+ The table is written to and read from a text file, one line for each board, channel and cell. Once set with @ref DAQEvent::SetOffsetCalibration(), the
+ offsets are subtracted while the ADC values are converted to Volts, in the same loop, see @ref DAQEvent::SetVolts(). The tool ```readWDoffsets```
+ writes the table of a pedestal run from the command line.
+
+ @code{.cpp}
+ DAQFile pedestals("path/to/pedestals.dat");
+ OffsetCalibration(pedestals).Write("offsets.txt");
+
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+ event.MakeConfig(file);
+ event.SetOffsetCalibration(OffsetCalibration("offsets.txt"));
+ while (file >> event)
+ {
+     // ...
+ }
+ @endcode
+ */
+class OffsetCalibration
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+
+public:
+    /*!
+     @brief Construct a new empty OffsetCalibration object.
+     */
+    OffsetCalibration() {}
+    OffsetCalibration(DAQFile &);
+    OffsetCalibration(WaveformAverage &);
+    OffsetCalibration(const std::string &);
+
+    OffsetCalibration &Write(const std::string &);
+    OffsetCalibration &SetOffsets(const std::vector<float> &, int, int);
+    const std::vector<float> &GetOffsets(int, int) const;
+    bool HasOffsets(int, int) const;
+    const MAP &GetOffsetMap() const { return offsets_; };
+    bool IsEmpty() const { return offsets_.empty(); };
+
+private:
+    template <typename T>
+    static void Accumulate(DAQFile &, WaveformAverage &);
+
+    MAP offsets_; ///< The offset of each cell in Volts, for each board and channel
+};
+
+#endif
@@ -0,0 +1,245 @@
+/*!
+ @file readWDPSD.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the pulse shape discrimination with a short and a long gate.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDPSD.hh"
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : PulseShapeDiscriminator                                       │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new PulseShapeDiscriminator object.
+
+ @param times The map of \f$ \Delta t\f$ of the ```TIME``` block, only the boards and channels are used.
+ @param pre The start of the gates before the reference time, in seconds, for all the channels.
+ @param short_gate The end of the short gate after the reference time, in seconds.
+ @param long_gate The end of the long gate after the reference time, in seconds.
+ @param reference The reference time.
+ @param fraction The fraction of the amplitude, for @ref PulseShapeDiscriminator::Reference::CF.
+ */
+PulseShapeDiscriminator::PulseShapeDiscriminator(const MAP &times, float pre, float short_gate, float long_gate, Reference reference, float fraction)
+    : channels_(times)
+{
+    gates_.resize(channels_.GetNChannels());
+    results_.assign(channels_.GetNChannels(), {0, 0, 0, 0});
+    if (gates_.empty())
+    {
+        cerr << "!! Error: no channels to be analysed" << endl;
+        exit(0);
+    }
+
+    (*this).SetGates(pre, short_gate, long_gate);
+    (*this).SetReference(reference, fraction);
+}
+
+/*!
+ @brief Check that the gates are valid.
+
+ @param pre The start of the gates before the reference time.
+ @param short_gate The end of the short gate after the reference time.
+ @param long_gate The end of the long gate after the reference time.
+ */
+void PulseShapeDiscriminator::Check(float pre, float short_gate, float long_gate)
+{
+    if (-pre >= short_gate or short_gate >= long_gate)
+    {
+        cerr << "!! Error: the gates must be ordered as -pre < short < long, passed values are " << -pre << ", " << short_gate << ", " << long_gate << endl;
+        exit(0);
+    }
+}
+
+/*!
+ @brief Set the gates of all the channels.
+
+ @param pre The start of the gates before the reference time, in seconds.
+ @param short_gate The end of the short gate after the reference time, in seconds.
+ @param long_gate The end of the long gate after the reference time, in seconds.
+ @return PulseShapeDiscriminator&
+ */
+PulseShapeDiscriminator &PulseShapeDiscriminator::SetGates(float pre, float short_gate, float long_gate)
+{
+    PulseShapeDiscriminator::Check(pre, short_gate, long_gate);
+    for (auto &gates : gates_)
+    {
+        gates.pre = pre;
+        gates.short_gate = short_gate;
+        gates.long_gate = long_gate;
+    }
+    return *this;
+}
+
+/*!
+ @brief Set the gates of a channel.
+
+ @param pre The start of the gates before the reference time, in seconds.
+ @param short_gate The end of the short gate after the reference time, in seconds.
+ @param long_gate The end of the long gate after the reference time, in seconds.
+ @param b The board.
+ @param c The channel.
+ @return PulseShapeDiscriminator&
+ */
+PulseShapeDiscriminator &PulseShapeDiscriminator::SetGates(float pre, float short_gate, float long_gate, int b, int c)
+{
+    PulseShapeDiscriminator::Check(pre, short_gate, long_gate);
+    auto &gates = gates_[channels_.Index(b, c)];
+    gates.pre = pre;
+    gates.short_gate = short_gate;
+    gates.long_gate = long_gate;
+    return *this;
+}
+
+/*!
+ @brief Set the reference time of all the channels.
+
+ @param reference The reference time.
+ @param fraction The fraction of the amplitude, in range (0, 1), for @ref PulseShapeDiscriminator::Reference::CF.
+ @return PulseShapeDiscriminator&
+ */
+PulseShapeDiscriminator &PulseShapeDiscriminator::SetReference(Reference reference, float fraction)
+{
+    for (auto &[bKey, bVal] : channels_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            (*this).SetReference(reference, fraction, bKey, cKey);
+        }
+    }
+    return *this;
+}
+
+/*!
+ @brief Set the reference time of a channel.
+
+ @param reference The reference time.
+ @param fraction The fraction of the amplitude, in range (0, 1), for @ref PulseShapeDiscriminator::Reference::CF.
+ @param b The board.
+ @param c The channel.
+ @return PulseShapeDiscriminator&
+ */
+PulseShapeDiscriminator &PulseShapeDiscriminator::SetReference(Reference reference, float fraction, int b, int c)
+{
+    if (fraction <= 0 or fraction >= 1)
+    {
+        cerr << "!! Error: CF value must be in range (0, 1)" << endl;
+        exit(0);
+    }
+    auto &gates = gates_[channels_.Index(b, c)];
+    gates.reference = reference;
+    gates.fraction = fraction;
+    return *this;
+}
+
+/*!
+ @brief Evaluate the charges and the ratio of a channel of an event.
+
+ @details The gates are clipped to the waveform. Each interval between two samples is integrated over its overlap with the long gate and with the short
+ gate, with the trapezoidal rule on the interpolated values at the ends of the overlap.
+
+ @param event The event.
+ @param b The board.
+ @param c The channel.
+ @return const PSDResult&
+ */
+const PSDResult &PulseShapeDiscriminator::Evaluate(DAQEvent &event, int b, int c)
+{
+    int k = channels_.Index(b, c);
+    auto &gates = gates_[k];
+    auto &result = results_[k];
+
+    float ped = event.GetChannel(b, c).GetPedestal().first;
+    int peak = event.GetChannel(b, c).GetPeakIndices()[0];
+    auto &volts = event.GetChannel(b, c).GetVolts();
+    auto &times = event.GetChannel(b, c).GetTimes();
+    int n = volts.size();
+
+    // Reference time
+    result.time = times[peak];
+    if (gates.reference == Reference::CF)
+    {
+        float amplitude = volts[peak] - ped;
+        float sign = amplitude < 0 ? -1 : 1;
+        float level = gates.fraction * abs(amplitude);
+        int j = peak;
+        while (j > 0 and sign * (volts[j] - ped) > level)
+        {
+            --j;
+        }
+        result.time = times[j];
+        float y0 = sign * (volts[j] - ped);
+        if (y0 <= level and j < peak)
+        {
+            float y1 = sign * (volts[j + 1] - ped);
+            result.time += (level - y0) * (times[j + 1] - times[j]) / (y1 - y0);
+        }
+    }
+
+    float start = max(result.time - gates.pre, times[0]);
+    float end_short = min(result.time + gates.short_gate, times[n - 1]);
+    float end_long = min(result.time + gates.long_gate, times[n - 1]);
+
+    // Charges of both gates in one pass over the samples from the start of the gates
+    int i = max<int>(upper_bound(times.begin(), times.end(), start) - times.begin() - 1, 0);
+    double short_charge = 0, long_charge = 0;
+    for (; i < n - 1 and times[i] < end_long; ++i)
+    {
+        float t0 = times[i], t1 = times[i + 1];
+        float y0 = volts[i] - ped, slope = (volts[i + 1] - volts[i]) / (t1 - t0);
+        auto overlap = [&](float end) -> double
+        {
+            float u = max(t0, start), v = min(t1, end);
+            if (v <= u)
+            {
+                return 0;
+            }
+            return (v - u) * (y0 + slope * (0.5f * (u + v) - t0));
+        };
+        long_charge += overlap(end_long);
+        short_charge += overlap(end_short);
+    }
+
+    result.short_charge = short_charge;
+    result.long_charge = long_charge;
+    result.ratio = long_charge != 0 ? (long_charge - short_charge) / long_charge : 0;
+    return result;
+}
+
+/*!
+ @brief Evaluate the charges and the ratios of all the channels of an event.
+
+ @param event The event.
+ @return PulseShapeDiscriminator& The results are given by @ref PulseShapeDiscriminator::GetResult().
+ */
+PulseShapeDiscriminator &PulseShapeDiscriminator::Evaluate(DAQEvent &event)
+{
+    for (auto &[bKey, bVal] : channels_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            (*this).Evaluate(event, bKey, cKey);
+        }
+    }
+    return *this;
+}
+
+/*!
+ @brief Getter method read-only for the last result of a channel.
+
+ @param b The board.
+ @param c The channel.
+ @return const PSDResult&
+ */
+const PSDResult &PulseShapeDiscriminator::GetResult(int b, int c)
+{
+    return results_[channels_.Index(b, c)];
+}
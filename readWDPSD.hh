@@ -0,0 +1,121 @@
+/*!
+ @file readWDPSD.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the pulse shape discrimination with a short and a long gate.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDPSD_H
+#define READWDPSD_H
+
+#include "readWD.hh"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ STRUCTURES                                                              │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Result of the pulse shape discrimination of a waveform.
+ */
+struct PSDResult
+{
+    float time;         ///< The reference time of the gates, in seconds.
+    float short_charge; ///< The integral of the waveform minus the pedestal in the short gate, in V s.
+    float long_charge;  ///< The integral of the waveform minus the pedestal in the long gate, in V s.
+    float ratio;        ///< The tail over the total, \f$ (Q_{long} - Q_{short}) / Q_{long}\f$, 0 if the long charge is null.
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Class to evaluate the charges in a short and in a long gate and their tail over total ratio.
+
+ @details Both gates start at the same time before a reference time of the pulse and end after it, the short gate first. The reference is the peak
+ found by @ref DAQEvent::FindPeaks() or the time at which the leading edge crosses a fraction of the amplitude, found walking back from the peak. The
+ pedestal and the peak already evaluated for the event are used, see @ref DAQEvent::GetPedestal() and @ref DAQEvent::GetPeakIndices(), and the
+ integration window of the channel is not changed: @ref DAQEvent::GetCharge() keeps working as before.
+
+ The two charges are integrated in a single pass from the start of the gates to the end of the long gate. The waveform is taken as linear between the
+ samples, so the gates can start and end between two samples: the charges do not jump when the reference time moves across a sample. Gates and
+ reference are set for each channel, the ratios of all the channels of an event are evaluated with one call. The instance is not shared between threads.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+ PulseShapeDiscriminator psd(file, 5e-9, 30e-9, 300e-9); // 5 ns before the peak, short gate 30 ns, long gate 300 ns
+
+ while (file >> event)
+ {
+     psd.Evaluate(event);
+     float ratio = psd.GetResult(0, 1).ratio;
+ }
+ @endcode
+ */
+class PulseShapeDiscriminator
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+
+public:
+    /*!
+     @brief The reference time of the gates.
+     */
+    enum class Reference
+    {
+        Peak, ///< The time of the peak.
+        CF    ///< The time at which the leading edge crosses a fraction of the amplitude.
+    };
+
+    PulseShapeDiscriminator(const MAP &, float, float, float, Reference = Reference::Peak, float = 0.5);
+    /*!
+     @brief Construct a new PulseShapeDiscriminator object for the channels of a file.
+
+     @param file The file, its ```TIME``` block is used.
+     @param pre The start of the gates before the reference time, in seconds.
+     @param short_gate The end of the short gate after the reference time, in seconds.
+     @param long_gate The end of the long gate after the reference time, in seconds.
+     @param reference The reference time.
+     @param fraction The fraction of the amplitude, for @ref PulseShapeDiscriminator::Reference::CF.
+     */
+    PulseShapeDiscriminator(DAQFile &file, float pre, float short_gate, float long_gate, Reference reference = Reference::Peak, float fraction = 0.5)
+        : PulseShapeDiscriminator(file.GetTimeMap(), pre, short_gate, long_gate, reference, fraction) {}
+
+    PulseShapeDiscriminator &SetGates(float, float, float);
+    PulseShapeDiscriminator &SetGates(float, float, float, int, int);
+    PulseShapeDiscriminator &SetReference(Reference, float = 0.5);
+    PulseShapeDiscriminator &SetReference(Reference, float, int, int);
+
+    const PSDResult &Evaluate(DAQEvent &, int, int);
+    PulseShapeDiscriminator &Evaluate(DAQEvent &);
+    const PSDResult &GetResult(int, int);
+
+private:
+    /*!
+     @brief The gates and the reference of a channel.
+     */
+    struct Gates
+    {
+        float pre;           ///< The start of the gates before the reference, in seconds.
+        float short_gate;    ///< The end of the short gate after the reference, in seconds.
+        float long_gate;     ///< The end of the long gate after the reference, in seconds.
+        Reference reference; ///< The reference time.
+        float fraction;      ///< The fraction of the amplitude for the constant fraction reference.
+    };
+
+    static void Check(float, float, float);
+
+    ChannelIndex channels_;                      ///< Index of each board and channel in the buffers
+    std::vector<Gates> gates_;                   ///< The gates of each channel
+    std::vector<PSDResult> results_;             ///< The last result of each channel
+};
+
+#endif
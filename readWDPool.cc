@@ -0,0 +1,95 @@
+/*!
+ @file readWDPool.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the pool of reusable events.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDPool.hh"
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : DAQEventPool                                                  │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new DAQEventPool::DAQEventPool object.
+
+ @param file The file to be read, it gives the boards and channels to allocate.
+ @param size The number of events in the pool.
+ @param prototype The event copied to build the events, with its settings.
+ */
+template <typename T>
+DAQEventPool<T>::DAQEventPool(DAQFile &file, size_t size, const T &prototype)
+{
+    if (file.GetType() != T::type_)
+    {
+        cerr << "!! Error: Invalid type of class used" << endl
+             << "Type expected: " << file.GetType() << endl
+             << "Event given: " << T::type_ << endl;
+        exit(0);
+    }
+
+    events_.reserve(size);
+    free_.reserve(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        events_.push_back(make_unique<T>(prototype));
+        events_.back()->Reserve(file);
+        free_.push_back(events_.back().get());
+    }
+}
+
+/*!
+ @brief Take a free event from the pool, waiting until one is released if all are in use.
+
+ @return T* The event, to be given back with @ref DAQEventPool::Release().
+ */
+template <typename T>
+T *DAQEventPool<T>::Acquire()
+{
+    unique_lock<mutex> lock(mutex_);
+    released_.wait(lock, [this]
+                   { return !free_.empty(); });
+    T *event = free_.back();
+    free_.pop_back();
+    return event;
+}
+
+/*!
+ @brief Give an event back to the pool.
+
+ @param event The event, taken with @ref DAQEventPool::Acquire().
+ @return DAQEventPool&
+ */
+template <typename T>
+DAQEventPool<T> &DAQEventPool<T>::Release(T *event)
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        free_.push_back(event);
+    }
+    released_.notify_one();
+    return *this;
+}
+
+/*!
+ @brief Getter method for the number of events not in use.
+
+ @return size_t
+ */
+template <typename T>
+size_t DAQEventPool<T>::GetNFree()
+{
+    lock_guard<mutex> lock(mutex_);
+    return free_.size();
+}
+
+template class DAQEventPool<DRSEvent>;
+template class DAQEventPool<WDBEvent>;
@@ -0,0 +1,67 @@
+/*!
+ @file readWDPool.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the pool of reusable events.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDPOOL_H
+#define READWDPOOL_H
+
+#include "readWD.hh"
+
+#include <condition_variable>
+#include <memory>
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Class to hold a fixed set of events, allocated once and reused.
+
+ @details All the events are built when the pool is built, as copies of a prototype event (so that they share its @ref DAQConfig settings), and their
+ buffers are allocated for the boards and channels of the file with @ref DAQEvent::Reserve(). Then reading an event and analysing it does not allocate
+ memory. The events can be passed between threads: a reader thread takes a free event with @ref DAQEventPool::Acquire(), fills it and passes it to an
+ analysis thread, which gives it back with @ref DAQEventPool::Release(). If no event is free, @ref DAQEventPool::Acquire() waits, so the reader cannot
+ run ahead of the analysis by more than the size of the pool.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DAQEventPool<DRSEvent> pool(file, 16);
+
+ DRSEvent *event = pool.Acquire();
+ while (file >> *event)
+ {
+     queue.push(event); // Analysed by another thread, that calls pool.Release(event)
+     event = pool.Acquire();
+ }
+ pool.Release(event);
+ @endcode
+ */
+template <typename T>
+class DAQEventPool
+{
+public:
+    DAQEventPool(DAQFile &, size_t, const T & = T());
+
+    T *Acquire();
+    DAQEventPool &Release(T *);
+
+    size_t GetSize() { return events_.size(); };
+    size_t GetNFree();
+
+private:
+    std::vector<std::unique_ptr<T>> events_; ///< The events owned by the pool.
+    std::vector<T *> free_;                  ///< The events not in use.
+    std::mutex mutex_;                       ///< Mutex to use the pool from many threads.
+    std::condition_variable released_;       ///< Notified when an event is released.
+};
+
+#endif
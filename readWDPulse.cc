@@ -0,0 +1,246 @@
+/*!
+ @file readWDPulse.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the search of many pulses in the waveforms.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDPulse.hh"
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : PulseFinder                                                   │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new PulseFinder object.
+
+ @param times The map of \f$ \Delta t\f$ of the ```TIME``` block.
+ @param n_samples The number of samples of the waveforms.
+ @param threshold The threshold from the pedestal in Volts, negative for negative pulses, for all the channels.
+ @param fraction The constant fraction of the amplitude for the time of the pulses.
+ */
+PulseFinder::PulseFinder(const MAP &times, int n_samples, float threshold, float fraction) : channels_(times)
+{
+    pulses_.resize(channels_.GetNChannels());
+    for (auto &pulses : pulses_)
+    {
+        pulses.reserve(n_samples / 2); // A pulse has at least two samples
+    }
+    if (pulses_.empty())
+    {
+        cerr << "!! Error: no channels to be searched" << endl;
+        exit(0);
+    }
+
+    threshold_.resize(pulses_.size());
+    (*this).SetThreshold(threshold);
+    (*this).SetFraction(fraction);
+}
+
+/*!
+ @brief Set the threshold of all the channels.
+
+ @param threshold The threshold from the pedestal in Volts, negative for negative pulses.
+ @return PulseFinder&
+ */
+PulseFinder &PulseFinder::SetThreshold(float threshold)
+{
+    if (threshold == 0)
+    {
+        cerr << "!! Error: the threshold must not be null" << endl;
+        exit(0);
+    }
+    fill(threshold_.begin(), threshold_.end(), threshold);
+    return *this;
+}
+
+/*!
+ @brief Set the threshold of a channel.
+
+ @param threshold The threshold from the pedestal in Volts, negative for negative pulses.
+ @param b The board.
+ @param c The channel.
+ @return PulseFinder&
+ */
+PulseFinder &PulseFinder::SetThreshold(float threshold, int b, int c)
+{
+    if (threshold == 0)
+    {
+        cerr << "!! Error: the threshold must not be null" << endl;
+        exit(0);
+    }
+    threshold_[channels_.Index(b, c)] = threshold;
+    return *this;
+}
+
+/*!
+ @brief Set the constant fraction for the time of the pulses.
+
+ @param fraction The fraction of the amplitude, in range (0, 1).
+ @return PulseFinder&
+ */
+PulseFinder &PulseFinder::SetFraction(float fraction)
+{
+    if (fraction <= 0 or fraction >= 1)
+    {
+        cerr << "!! Error: CF value must be in range (0, 1)" << endl;
+        exit(0);
+    }
+    fraction_ = fraction;
+    return *this;
+}
+
+/*!
+ @brief Find the pulses of a channel of an event.
+
+ @details The waveform is taken with the sign of the threshold, so that the pulses are always positive. The integral from the beginning of the sweep is
+ accumulated sample by sample and saved at the beginning of each pulse and in the valleys, so the charge of a pulse is the difference of two saved values.
+ If the constant fraction is crossed before the first sample of the pulse, which happens in a valley, the time of the first sample is taken.
+
+ @param event The event.
+ @param b The board.
+ @param c The channel.
+ @return const vector<Pulse>& The pulses, in the order of time.
+ */
+const vector<Pulse> &PulseFinder::Find(DAQEvent &event, int b, int c)
+{
+    int k = channels_.Index(b, c);
+    auto &pulses = pulses_[k];
+    pulses.clear();
+
+    auto &ped = event.GetChannel(b, c).GetPedestal();
+    auto &volts = event.GetChannel(b, c).GetVolts();
+    auto &times = event.GetChannel(b, c).GetTimes();
+    int n = volts.size();
+    if (n < 22)
+    {
+        return pulses;
+    }
+
+    float sign = threshold_[k] < 0 ? -1 : 1;
+    float thr = abs(threshold_[k]);
+    float base = ped.first;
+    float low = min(5 * ped.second, thr / 2);
+    auto y = [&](int i) -> float
+    { return sign * (volts[i] - base); };
+
+    auto add = [&](int start, int stop, int peak, double charge)
+    {
+        if (y(peak) <= thr)
+        {
+            return;
+        }
+        float level = fraction_ * y(peak);
+        int j = peak;
+        while (j > start and y(j) > level)
+        {
+            --j;
+        }
+        float time = times[j];
+        if (y(j) <= level)
+        {
+            time += (level - y(j)) * (times[j + 1] - times[j]) / (y(j + 1) - y(j));
+        }
+        pulses.push_back({start, stop, peak, volts[peak] - base, (float)(sign * charge), time});
+    };
+
+    bool open = false;
+    int start = 0, peak = 0, valley = -1;
+    double area = 0, area_start = 0, area_valley = 0;
+    float prev = y(10);
+    for (int i = 10; i < n - 10; ++i)
+    {
+        float yi = y(i);
+        double area_prev = area;
+        if (i > 10)
+        {
+            area += 0.5 * (prev + yi) * (times[i] - times[i - 1]);
+        }
+        prev = yi;
+
+        if (!open)
+        {
+            if (yi > low)
+            {
+                open = true;
+                start = i > 10 ? i - 1 : i;
+                area_start = i > 10 ? area_prev : area;
+                peak = i;
+                valley = -1;
+            }
+        }
+        else if (yi <= low) // Back on the baseline
+        {
+            add(start, i, peak, area - area_start);
+            open = false;
+        }
+        else if (valley < 0) // Rising to the peak, or falling from it
+        {
+            if (yi > y(peak))
+            {
+                peak = i;
+            }
+            else if (yi < y(peak) - thr)
+            {
+                valley = i;
+                area_valley = area;
+            }
+        }
+        else if (yi < y(valley)) // Going down in the valley
+        {
+            valley = i;
+            area_valley = area;
+        }
+        else if (yi > y(valley) + thr) // Another pulse on the tail of the previous one
+        {
+            add(start, valley, peak, area_valley - area_start);
+            start = valley;
+            area_start = area_valley;
+            peak = i;
+            valley = -1;
+        }
+    }
+    if (open)
+    {
+        add(start, n - 11, peak, area - area_start);
+    }
+
+    return pulses;
+}
+
+/*!
+ @brief Find the pulses of all the channels of an event.
+
+ @param event The event.
+ @return PulseFinder& The pulses are given by @ref PulseFinder::GetPulses().
+ */
+PulseFinder &PulseFinder::Find(DAQEvent &event)
+{
+    for (auto &[bKey, bVal] : channels_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            (*this).Find(event, bKey, cKey);
+        }
+    }
+    return *this;
+}
+
+/*!
+ @brief Getter method read-only for the pulses of a channel found in the last event.
+
+ @param b The board.
+ @param c The channel.
+ @return const vector<Pulse>&
+ */
+const vector<Pulse> &PulseFinder::GetPulses(int b, int c)
+{
+    return pulses_[channels_.Index(b, c)];
+}
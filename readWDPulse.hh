@@ -0,0 +1,104 @@
+/*!
+ @file readWDPulse.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the search of many pulses in the waveforms.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDPULSE_H
+#define READWDPULSE_H
+
+#include "readWD.hh"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ STRUCTURES                                                              │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief A pulse found in a waveform.
+ */
+struct Pulse
+{
+    int start;       ///< The index of the first sample, on the baseline before the pulse or in the valley after the previous one.
+    int stop;        ///< The index of the last sample, on the baseline after the pulse or in the valley before the next one.
+    int peak;        ///< The index of the peak.
+    float amplitude; ///< The height of the peak from the pedestal in Volts, negative for negative pulses.
+    float charge;    ///< The integral of the waveform minus the pedestal from the first to the last sample, in V s.
+    float time;      ///< The time at which the leading edge crosses the constant fraction of the amplitude, in seconds.
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Class to find all the pulses of the waveforms, also when they pile up.
+
+ @details @ref DAQEvent::GetCharge() and @ref DAQEvent::GetTimeCF() describe only the first pulse of a waveform. Here all the pulses are found with a
+ single sweep over the samples, from the 10th to the 10th to last as in @ref DAQEvent::FindPeaks():
+    -# a region starts when the waveform goes further than \f$ 5\sigma\f$ from the pedestal, as the integration window of
+       @ref DAQEvent::EvalIntegrationBounds(), and ends when it comes back. The pedestal is the one of @ref DAQEvent::GetPedestal();
+    -# a region is a pulse if its peak goes over the threshold;
+    -# a region with more pulses piled up is split in the valley between two peaks, when the waveform falls by more than the threshold after a peak
+       and rises again by more than the threshold.
+
+ The charge is integrated while sweeping, from the first to the last sample of the pulse: the tails closer than \f$ 5\sigma\f$ to the pedestal are not
+ included. The constant fraction time is interpolated on the leading edge of each pulse. The threshold is given from the pedestal, its sign is the
+ polarity of the pulses. The pulses of each channel are stored in a buffer allocated once, so finding the pulses of an event does not allocate memory.
+ The instance is not shared between threads.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+ PulseFinder finder(file, -0.02); // Negative pulses higher than 20 mV
+
+ while (file >> event)
+ {
+     finder.Find(event);
+     for (auto &pulse : finder.GetPulses(0, 1))
+     {
+         // pulse.time, pulse.amplitude, pulse.charge
+     }
+ }
+ @endcode
+ */
+class PulseFinder
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+
+public:
+    PulseFinder(const MAP &, int, float, float = 0.5);
+    /*!
+     @brief Construct a new PulseFinder object for the channels of a file.
+
+     @param file The file, its ```TIME``` block and its number of samples are used.
+     @param threshold The threshold from the pedestal in Volts, negative for negative pulses.
+     @param fraction The constant fraction of the amplitude for the time of the pulses.
+     */
+    PulseFinder(DAQFile &file, float threshold, float fraction = 0.5) : PulseFinder(file.GetTimeMap(), file.GetNSamples(), threshold, fraction) {}
+
+    PulseFinder &SetThreshold(float);
+    PulseFinder &SetThreshold(float, int, int);
+    PulseFinder &SetFraction(float);
+
+    const std::vector<Pulse> &Find(DAQEvent &, int, int);
+    PulseFinder &Find(DAQEvent &);
+    const std::vector<Pulse> &GetPulses(int, int);
+
+private:
+
+    ChannelIndex channels_;                      ///< Index of each board and channel in the buffers
+    std::vector<float> threshold_;               ///< The threshold of each channel, in Volts from the pedestal
+    float fraction_;                             ///< The constant fraction for the time of the pulses
+    std::vector<std::vector<Pulse>> pulses_;     ///< The pulses of each channel
+};
+
+#endif
@@ -0,0 +1,364 @@
+/*!
+ @file readWDRDF.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the ROOT::RDataFrame data source over @ref DAQFile.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDRDF.hh"
+
+#include <cstddef>
+#include <typeinfo>
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : DAQDataSource                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new @ref DAQDataSource object.
+
+ @details The file is opened once to know the type of board, the boards and channels contained and the number of events. The list of columns
+ is built accordingly.
+
+ @param fname The file name to be read.
+ @param cf The constant fraction used to evaluate the `timeCF` columns, see @ref DAQEvent::GetTimeCF().
+ */
+DAQDataSource::DAQDataSource(string_view fname, float cf)
+{
+    filename_ = string(fname);
+    cf_ = cf;
+    n_slots_ = 0;
+    ranges_given_ = false;
+
+    DAQFile file(filename_);
+    type_ = file.GetType();
+    if (type_.empty())
+    {
+        cerr << "!! Error: unable to initialise file " << filename_ << endl;
+        exit(0);
+    }
+    n_events_ = file.GetNEvents();
+
+    const vector<pair<string, size_t>> header{{"serialNumber", offsetof(EventHeader, serialNumber)},
+                                              {"year", offsetof(EventHeader, year)},
+                                              {"month", offsetof(EventHeader, month)},
+                                              {"day", offsetof(EventHeader, day)},
+                                              {"hour", offsetof(EventHeader, hour)},
+                                              {"min", offsetof(EventHeader, min)},
+                                              {"sec", offsetof(EventHeader, sec)},
+                                              {"ms", offsetof(EventHeader, ms)},
+                                              {"rangeCenter", offsetof(EventHeader, rangeCenter)}};
+    for (auto &[name, offset] : header)
+    {
+        col_names_.push_back(name);
+        cols_.push_back({Kind::HEADER, -1, -1, name == "serialNumber" ? "unsigned int" : "unsigned short", offset});
+    }
+
+    const vector<tuple<string, Kind, string>> channel{{"volts", Kind::VOLTS, "ROOT::VecOps::RVec<float>"},
+                                                      {"times", Kind::TIMES, "ROOT::VecOps::RVec<float>"},
+                                                      {"pedestal", Kind::PEDESTAL, "float"},
+                                                      {"pedestalRMS", Kind::PEDESTALRMS, "float"},
+                                                      {"charge", Kind::CHARGE, "float"},
+                                                      {"amplitude", Kind::AMPLITUDE, "float"},
+                                                      {"timeCF", Kind::TIMECF, "float"}};
+    for (auto &[bKey, bVal] : file.GetTimeMap())
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            for (auto &[name, kind, type] : channel)
+            {
+                col_names_.push_back(name + "_b" + to_string(bKey) + "_c" + to_string(cKey));
+                cols_.push_back({kind, bKey, cKey, type, 0});
+            }
+        }
+    }
+    col_used_.assign(cols_.size(), false);
+}
+
+/*!
+ @brief Set the number of slots, one @ref DAQEvent is created for each slot.
+
+ @param nSlots The number of slots.
+ */
+void DAQDataSource::SetNSlots(unsigned int nSlots)
+{
+    n_slots_ = nSlots;
+    slots_.resize(n_slots_);
+
+    for (auto &slot : slots_)
+    {
+        if (type_ == WDBEvent::type_)
+        {
+            slot.wdb = make_unique<WDBEvent>();
+            slot.event = slot.wdb.get();
+        }
+        else
+        {
+            slot.drs = make_unique<DRSEvent>();
+            slot.event = slot.drs.get();
+        }
+        slot.next_entry = 0;
+        slot.waves.resize(cols_.size());
+        slot.features.resize(cols_.size());
+        slot.addr.resize(cols_.size());
+
+        auto eh = (char *)&slot.event->GetEH();
+        for (size_t k = 0; k < cols_.size(); ++k)
+        {
+            switch (cols_[k].kind)
+            {
+            case Kind::HEADER:
+                slot.addr[k] = eh + cols_[k].offset;
+                break;
+            case Kind::VOLTS:
+            case Kind::TIMES:
+                slot.addr[k] = &slot.waves[k];
+                break;
+            default:
+                slot.addr[k] = &slot.features[k];
+            }
+        }
+    }
+}
+
+/*!
+ @brief Check if a column is provided by the data source.
+
+ @param colName The name of the column.
+ @return true
+ @return false
+ */
+bool DAQDataSource::HasColumn(string_view colName) const
+{
+    return find(col_names_.begin(), col_names_.end(), colName) != col_names_.end();
+}
+
+/*!
+ @brief Get the type of a column.
+
+ @param colName The name of the column.
+ @return string The type name.
+ */
+string DAQDataSource::GetTypeName(string_view colName) const
+{
+    auto it = find(col_names_.begin(), col_names_.end(), colName);
+    if (it == col_names_.end())
+    {
+        cerr << "!! Error: column " << colName << " not found in " << filename_ << endl;
+        exit(0);
+    }
+    return cols_[distance(col_names_.begin(), it)].type;
+}
+
+/*!
+ @brief Give to RDataFrame the address of the values of a column for each slot.
+
+ @param colName The name of the column.
+ @param ti The type requested by RDataFrame, checked against the type of the column.
+ @return Record_t The addresses, one for each slot.
+ */
+DAQDataSource::Record_t DAQDataSource::GetColumnReadersImpl(string_view colName, const type_info &ti)
+{
+    auto it = find(col_names_.begin(), col_names_.end(), colName);
+    if (it == col_names_.end())
+    {
+        cerr << "!! Error: column " << colName << " not found in " << filename_ << endl;
+        exit(0);
+    }
+    auto k = distance(col_names_.begin(), it);
+
+    bool valid;
+    switch (cols_[k].kind)
+    {
+    case Kind::HEADER:
+        valid = (cols_[k].type == "unsigned int") ? ti == typeid(unsigned int) : ti == typeid(unsigned short);
+        break;
+    case Kind::VOLTS:
+    case Kind::TIMES:
+        valid = ti == typeid(ROOT::RVec<float>);
+        break;
+    default:
+        valid = ti == typeid(float);
+    }
+
+    if (!valid)
+    {
+        cerr << "!! Error: invalid type requested for column " << colName << " --> expected " << cols_[k].type << endl;
+        exit(0);
+    }
+
+    col_used_[k] = true;
+    Record_t readers;
+    for (auto &slot : slots_)
+    {
+        readers.push_back(&slot.addr[k]);
+    }
+    return readers;
+}
+
+/*!
+ @brief Reset the entry ranges at the beginning of each event loop.
+
+ */
+void DAQDataSource::Initialise()
+{
+    ranges_given_ = false;
+}
+
+/*!
+ @brief Split the events in ranges, one for each slot.
+
+ @details The ranges are given all at once at the first call, then an empty vector is returned to tell RDataFrame that there are no more entries.
+
+ @return vector<pair<ULong64_t, ULong64_t>>
+ */
+vector<pair<ULong64_t, ULong64_t>> DAQDataSource::GetEntryRanges()
+{
+    vector<pair<ULong64_t, ULong64_t>> ranges;
+    if (ranges_given_)
+    {
+        return ranges;
+    }
+    ranges_given_ = true;
+
+    ULong64_t chunk = n_events_ / n_slots_;
+    ULong64_t rest = n_events_ % n_slots_;
+    ULong64_t start = 0;
+    for (unsigned int i = 0; i < n_slots_ and start < n_events_; ++i)
+    {
+        ULong64_t stop = start + chunk + (i < rest ? 1 : 0);
+        ranges.push_back({start, stop});
+        start = stop;
+    }
+    return ranges;
+}
+
+/*!
+ @brief Open the file of the slot, if not yet done.
+
+ @param slot The slot.
+ @param firstEntry The first entry of the range to be processed, the file is moved there.
+ */
+void DAQDataSource::InitSlot(unsigned int slot, ULong64_t firstEntry)
+{
+    auto &s = slots_[slot];
+    if (!s.file)
+    {
+        s.file = make_unique<DAQFile>(filename_);
+        s.next_entry = 0;
+    }
+
+    if (firstEntry != s.next_entry)
+    {
+        s.file->in_.clear();
+        s.file->in_.seekg(s.file->first_evt_pos_ + (long)firstEntry * s.file->EvalEventSize());
+        s.next_entry = firstEntry;
+    }
+}
+
+/*!
+ @brief Read the event of a given entry and fill the columns requested.
+
+ @param slot The slot.
+ @param entry The entry, i.e. the position of the event in the file starting from 0.
+ @return true
+ @return false
+ */
+bool DAQDataSource::SetEntry(unsigned int slot, ULong64_t entry)
+{
+    auto &s = slots_[slot];
+    if (entry != s.next_entry)
+    {
+        (*this).InitSlot(slot, entry);
+    }
+
+    if (!(*this).ReadEvent(s))
+    {
+        return false;
+    }
+    s.next_entry = entry + 1;
+
+    for (size_t k = 0; k < cols_.size(); ++k)
+    {
+        if (!col_used_[k])
+        {
+            continue;
+        }
+
+        auto &col = cols_[k];
+        switch (col.kind)
+        {
+        case Kind::HEADER:
+            break;
+        case Kind::VOLTS:
+        {
+            auto &volts = s.event->GetChannel(col.board, col.channel).GetVolts();
+            s.waves[k].assign(volts.begin(), volts.end());
+            break;
+        }
+        case Kind::TIMES:
+        {
+            auto &times = s.event->GetChannel(col.board, col.channel).GetTimes();
+            s.waves[k].assign(times.begin(), times.end());
+            break;
+        }
+        case Kind::PEDESTAL:
+            s.features[k] = s.event->GetChannel(col.board, col.channel).GetPedestal().first;
+            break;
+        case Kind::PEDESTALRMS:
+            s.features[k] = s.event->GetChannel(col.board, col.channel).GetPedestal().second;
+            break;
+        case Kind::CHARGE:
+            s.features[k] = s.event->GetChannel(col.board, col.channel).GetCharge();
+            break;
+        case Kind::AMPLITUDE:
+            s.features[k] = s.event->GetChannel(col.board, col.channel).GetAmplitude();
+            break;
+        case Kind::TIMECF:
+            s.features[k] = s.event->GetChannel(col.board, col.channel).GetTimeCF(cf_);
+            break;
+        }
+    }
+    return true;
+}
+
+/*!
+ @brief Read the next event of the slot's file into the slot's event.
+
+ @param s The slot.
+ @return true
+ @return false
+ */
+bool DAQDataSource::ReadEvent(Slot &s)
+{
+    if (s.wdb)
+    {
+        return *s.file >> *s.wdb;
+    }
+    return *s.file >> *s.drs;
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ FUNCTIONS                                                               │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Function to build a `ROOT::RDataFrame` reading a DRS/WDB binary file.
+
+ @param fname The file name.
+ @param cf The constant fraction used to evaluate the `timeCF` columns.
+ @return ROOT::RDataFrame
+ */
+ROOT::RDataFrame MakeDAQDataFrame(string_view fname, float cf)
+{
+    return ROOT::RDataFrame(make_unique<DAQDataSource>(fname, cf));
+}
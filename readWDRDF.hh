@@ -0,0 +1,125 @@
+/*!
+ @file readWDRDF.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the ROOT::RDataFrame data source over @ref DAQFile.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDRDF_H
+#define READWDRDF_H
+
+#include "readWD.hh"
+
+#include <memory>
+#include <string_view>
+
+#include "ROOT/RDataFrame.hxx"
+#include "ROOT/RDataSource.hxx"
+#include "ROOT/RVec.hxx"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Data source to read a DRS/WDB binary file with `ROOT::RDataFrame`.
+
+ @details The data source exposes one entry per event. The columns available are:
+    - the fields of @ref EventHeader: `serialNumber`, `year`, `month`, `day`, `hour`, `min`, `sec`, `ms`, `rangeCenter`;
+    - for each board `b` and channel `c` the waveforms as `ROOT::RVec<float>`: `volts_b<b>_c<c>`, `times_b<b>_c<c>`;
+    - for each board `b` and channel `c` the features evaluated by @ref DAQEvent: `pedestal_b<b>_c<c>`, `pedestalRMS_b<b>_c<c>`,
+      `charge_b<b>_c<c>`, `amplitude_b<b>_c<c>`, `timeCF_b<b>_c<c>`.
+
+ Only the columns used by the computation graph are filled. The events are split in as many ranges as the number of slots,
+ each slot owns its own @ref DAQFile so that the implicit multithreading of ROOT (`ROOT::EnableImplicitMT()`) is supported.
+ */
+class DAQDataSource final : public ROOT::RDF::RDataSource
+{
+public:
+    DAQDataSource(std::string_view, float = 0.5);
+
+    void SetNSlots(unsigned int) final;
+    const std::vector<std::string> &GetColumnNames() const final { return col_names_; };
+    bool HasColumn(std::string_view) const final;
+    std::string GetTypeName(std::string_view) const final;
+    std::vector<std::pair<ULong64_t, ULong64_t>> GetEntryRanges() final;
+    bool SetEntry(unsigned int, ULong64_t) final;
+    void InitSlot(unsigned int, ULong64_t) final;
+    void Initialise() final;
+    std::string GetLabel() final { return "DAQDataSource"; };
+
+protected:
+    Record_t GetColumnReadersImpl(std::string_view, const std::type_info &) final;
+
+private:
+    /*!
+     @brief Kind of value stored in a column.
+     */
+    enum class Kind
+    {
+        HEADER,      ///< A field of the event header.
+        VOLTS,       ///< The waveform voltages.
+        TIMES,       ///< The waveform times.
+        PEDESTAL,    ///< The pedestal mean.
+        PEDESTALRMS, ///< The pedestal std.dev.
+        CHARGE,      ///< The charge.
+        AMPLITUDE,   ///< The amplitude.
+        TIMECF       ///< The time at constant fraction.
+    };
+
+    /*!
+     @brief Description of a column.
+     */
+    struct Column
+    {
+        Kind kind;         ///< The kind of column.
+        int board;         ///< The board index, -1 for header fields.
+        int channel;       ///< The channel index, -1 for header fields.
+        std::string type;  ///< The type name as returned by @ref DAQDataSource::GetTypeName().
+        size_t offset;     ///< Offset of the field inside @ref EventHeader, only for header fields.
+    };
+
+    /*!
+     @brief Data owned by every slot.
+     */
+    struct Slot
+    {
+        std::unique_ptr<DAQFile> file;         ///< The file, opened once per slot.
+        std::unique_ptr<DRSEvent> drs;         ///< The event if the file comes from a DRS board.
+        std::unique_ptr<WDBEvent> wdb;         ///< The event if the file comes from a WDB board.
+        DAQEvent *event;                       ///< Pointer to the event in use.
+        ULong64_t next_entry;                  ///< The entry that the file is going to read without seeking.
+        std::vector<ROOT::RVec<float>> waves;  ///< Storage of waveform columns, one for each column.
+        std::vector<float> features;           ///< Storage of feature columns, one for each column.
+        std::vector<void *> addr;              ///< Address of the value of each column.
+    };
+
+    bool ReadEvent(Slot &);
+
+    std::string filename_;                  ///< The name of the file.
+    float cf_;                              ///< Constant fraction used for the `timeCF` columns.
+    std::string type_;                      ///< The type of board, "DRS" or "WDB".
+    ULong64_t n_events_;                    ///< The number of events in the file.
+    unsigned int n_slots_;                  ///< The number of slots.
+    bool ranges_given_;                     ///< Flag to check if the entry ranges were already given to RDataFrame.
+    std::vector<std::string> col_names_;    ///< The names of all columns.
+    std::vector<Column> cols_;              ///< The description of all columns, same order of @ref DAQDataSource::col_names_.
+    std::vector<bool> col_used_;            ///< Columns requested by the computation graph.
+    std::vector<Slot> slots_;               ///< Data owned by each slot.
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ FUNCTIONS                                                               │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+ROOT::RDataFrame MakeDAQDataFrame(std::string_view, float = 0.5);
+
+#endif
@@ -0,0 +1,248 @@
+/*!
+ @file readWDResample.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the resampling of the waveforms on a uniform time grid.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDResample.hh"
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : WaveformResampler                                             │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new WaveformResampler object.
+
+ @details The default grid is evaluated, see @ref WaveformResampler. No table is built until the first event is resampled.
+
+ @param times The map of \f$ \Delta t\f$ of the ```TIME``` block.
+ @param n_samples The number of samples of the waveforms.
+ @param period The period of the grid, in seconds.
+ @param method The interpolation.
+ */
+WaveformResampler::WaveformResampler(const MAP &times, int n_samples, float period, Interpolation method) : channels_(times)
+{
+    times_ = times;
+    n_samples_ = n_samples;
+    taps_ = method == Interpolation::Linear ? 2 : 4;
+    period_ = period;
+
+    if (period <= 0)
+    {
+        cerr << "!! Error: the period of the grid must be positive, passed value is " << period << endl;
+        exit(0);
+    }
+    if (n_samples_ < taps_)
+    {
+        cerr << "!! Error: waveforms of " << n_samples_ << " samples are too short to be interpolated" << endl;
+        exit(0);
+    }
+
+    // The first sample is at dt[tCell], the last one at the sum of n dt from tCell
+    double first = 0, last = INFINITY;
+    for (auto &[bKey, bVal] : times_)
+    {
+        for (auto &[cKey, dt] : bVal)
+        {
+            tables_.emplace_back(dt.size());
+            volts_.emplace_back();
+
+            size_t cells = dt.size();
+            vector<double> sum(cells + n_samples_ + 1, 0);
+            for (size_t c = 0; c < cells + n_samples_; ++c)
+            {
+                sum[c + 1] = sum[c] + dt[c % cells];
+            }
+            for (size_t c = 0; c < cells; ++c)
+            {
+                first = max(first, (double)dt[c]);
+                last = min(last, sum[c + n_samples_] - sum[c]);
+            }
+        }
+    }
+
+    if (tables_.empty() or last < first)
+    {
+        cerr << "!! Error: no channels to be resampled" << endl;
+        exit(0);
+    }
+    (*this).SetGrid(first, (last - first) / period_ + 1);
+}
+
+/*!
+ @brief Set the grid.
+
+ @details The tables already built are cleared.
+
+ @param start The time of the first point, in seconds.
+ @param n The number of points.
+ @return WaveformResampler&
+ */
+WaveformResampler &WaveformResampler::SetGrid(float start, int n)
+{
+    if (n < 1)
+    {
+        cerr << "!! Error: the grid must have at least one point, passed value is " << n << endl;
+        exit(0);
+    }
+
+    grid_.resize(n);
+    for (int k = 0; k < n; ++k)
+    {
+        grid_[k] = start + k * period_;
+    }
+
+    for (auto &tables : tables_)
+    {
+        for (auto &table : tables)
+        {
+            table = Table();
+        }
+    }
+    for (auto &volts : volts_)
+    {
+        volts.resize(n);
+    }
+    return *this;
+}
+
+/*!
+ @brief Resample a channel of an event.
+
+ @param event The event.
+ @param b The board.
+ @param c The channel.
+ @return const vector<float>& The resampled waveform, at the times of @ref WaveformResampler::GetTimes().
+ */
+const vector<float> &WaveformResampler::Resample(DAQEvent &event, int b, int c)
+{
+    int k = channels_.Index(b, c);
+    unsigned short tCell = event.GetChannel(b, c).GetTriggerCell();
+    auto &volts = event.GetChannel(b, c).GetVolts();
+    if ((int)volts.size() != n_samples_)
+    {
+        cerr << "!! Error: waveform of " << volts.size() << " samples, the resampler expects " << n_samples_ << endl;
+        exit(0);
+    }
+
+    auto &tables = tables_[k];
+    auto &table = tables[tCell % tables.size()];
+    if (table.index.empty())
+    {
+        (*this).Build(table, times_[b][c], tCell);
+    }
+
+    // Weighted sum of the samples, one sample used at a time
+    auto &out = volts_[k];
+    int n = grid_.size();
+    const int *index = table.index.data();
+    const float *v = volts.data();
+    const float *w = table.weight.data();
+    for (int p = 0; p < n; ++p)
+    {
+        out[p] = w[p] * v[index[p]];
+    }
+    for (int m = 1; m < taps_; ++m)
+    {
+        const float *vm = v + m;
+        const float *wm = w + m * n;
+        for (int p = 0; p < n; ++p)
+        {
+            out[p] += wm[p] * vm[index[p]];
+        }
+    }
+    return out;
+}
+
+/*!
+ @brief Resample all the channels of an event.
+
+ @param event The event.
+ @return WaveformResampler& The resampled waveforms are given by @ref WaveformResampler::GetVolts().
+ */
+WaveformResampler &WaveformResampler::Resample(DAQEvent &event)
+{
+    for (auto &[bKey, bVal] : channels_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            (*this).Resample(event, bKey, cKey);
+        }
+    }
+    return *this;
+}
+
+/*!
+ @brief Getter method read-only for the last resampled waveform of a channel.
+
+ @param b The board.
+ @param c The channel.
+ @return const vector<float>&
+ */
+const vector<float> &WaveformResampler::GetVolts(int b, int c)
+{
+    return volts_[channels_.Index(b, c)];
+}
+
+/*!
+ @brief Build the table of a channel and a trigger cell.
+
+ @details The times of the samples are evaluated as in @ref DAQEvent::TimeCalibration(), then grid and samples are walked together: for each point the
+ samples around it are found and their weights evaluated. The points outside the waveform are moved to the first or last sample.
+
+ @param table The table.
+ @param dt The \f$ \Delta t\f$ of the channel.
+ @param tCell The trigger cell.
+ */
+void WaveformResampler::Build(Table &table, const vector<float> &dt, unsigned short tCell)
+{
+    vector<float> t(n_samples_);
+    size_t cells = dt.size();
+    size_t c = tCell % cells;
+    float acc = 0;
+    for (int k = 0; k < n_samples_; ++k)
+    {
+        acc += dt[c];
+        t[k] = acc;
+        if (++c == cells)
+        {
+            c = 0;
+        }
+    }
+
+    int n = grid_.size();
+    table.index.resize(n);
+    table.weight.resize(taps_ * n);
+    int i = 0;
+    for (int p = 0; p < n; ++p)
+    {
+        double g = min(max((double)grid_[p], (double)t[0]), (double)t[n_samples_ - 1]);
+        while (i < n_samples_ - 2 and t[i + 1] < g)
+        {
+            ++i;
+        }
+
+        int first = taps_ == 2 ? i : min(max(i - 1, 0), n_samples_ - 4);
+        table.index[p] = first;
+        for (int m = 0; m < taps_; ++m)
+        {
+            double w = 1;
+            for (int l = 0; l < taps_; ++l)
+            {
+                if (l != m)
+                {
+                    w *= (g - t[first + l]) / ((double)t[first + m] - t[first + l]);
+                }
+            }
+            table.weight[m * n + p] = w;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*!
+ @file readWDResample.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the resampling of the waveforms on a uniform time grid.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDRESAMPLE_H
+#define READWDRESAMPLE_H
+
+#include "readWD.hh"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Class to resample the waveforms of an event on a uniform time grid.
+
+ @details The times of the samples are not uniform: they depend on the \f$ \Delta t\f$ of the ```TIME``` block of the channel and on the trigger cell
+ (see @ref DAQEvent::TimeCalibration()). For a given channel and trigger cell the times are always the same, so the position of each point of the grid
+ between the samples and its interpolation weights are evaluated the first time the pair is met and stored in a table. The following events with the
+ same pair are resampled with a weighted sum over the table, vectorised by the compiler. A table holds 4 bytes for the index and 4 bytes for each weight
+ for every point of the grid, i.e. about 12 kB (linear) or 20 kB (cubic) for 1024 points: with all the trigger cells met, 12 MB or 20 MB for each channel.
+
+ The grid is the same for all the channels: by default it starts at the latest first sample and ends at the earliest last sample among all the channels and
+ trigger cells, so that it is always covered by the waveforms. Points of a grid set with @ref WaveformResampler::SetGrid() outside the waveform take the value
+ of the first or last sample. The instance is not shared between threads.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+ WaveformResampler resampler(file, 0.2e-9); // 0.2 ns, linear interpolation
+
+ while (file >> event)
+ {
+     auto &volts = resampler.Resample(event, 0, 1);
+     // ... volts[k] at time resampler.GetTimes()[k]
+ }
+ @endcode
+ */
+class WaveformResampler
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+
+public:
+    /*!
+     @brief The interpolation between the samples.
+     */
+    enum class Interpolation
+    {
+        Linear, ///< Linear interpolation between the two samples around the point.
+        Cubic   ///< Cubic Lagrange interpolation on the four samples around the point, with their actual times.
+    };
+
+    WaveformResampler(const MAP &, int, float, Interpolation = Interpolation::Linear);
+    /*!
+     @brief Construct a new WaveformResampler object for the channels of a file.
+
+     @param file The file, its ```TIME``` block and its number of samples are used.
+     @param period The period of the grid, in seconds.
+     @param method The interpolation.
+     */
+    WaveformResampler(DAQFile &file, float period, Interpolation method = Interpolation::Linear) : WaveformResampler(file.GetTimeMap(), file.GetNSamples(), period, method) {}
+
+    WaveformResampler &SetGrid(float, int);
+    const std::vector<float> &Resample(DAQEvent &, int, int);
+    WaveformResampler &Resample(DAQEvent &);
+
+    const std::vector<float> &GetVolts(int, int);
+    const std::vector<float> &GetTimes() { return grid_; };
+    float GetPeriod() { return period_; };
+
+private:
+    /*!
+     @brief Interpolation of the grid for one channel and one trigger cell.
+     */
+    struct Table
+    {
+        std::vector<int> index;    ///< For each point, the index of the first sample used.
+        std::vector<float> weight; ///< The weights of the samples, one block of points for each sample used.
+    };
+
+    void Build(Table &, const std::vector<float> &, unsigned short);
+
+    MAP times_;                                  ///< The \f$ \Delta t\f$ of the ```TIME``` block
+    ChannelIndex channels_;                      ///< Index of each board and channel in the tables
+    int n_samples_;                              ///< Number of samples of the waveforms
+    int taps_;                                   ///< Number of samples used for each point, 2 or 4
+    float period_;                               ///< Period of the grid, in seconds
+    std::vector<float> grid_;                    ///< Times of the points of the grid
+    std::vector<std::vector<Table>> tables_;     ///< Tables of each channel and trigger cell, built when first needed
+    std::vector<std::vector<float>> volts_;      ///< The resampled waveform of each channel
+};
+
+#endif
@@ -0,0 +1,427 @@
+/*!
+ @file readWDSpectrum.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the Fourier transform and of the spectral analysis of the waveforms.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDSpectrum.hh"
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : FFTPlan                                                       │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new FFTPlan object.
+
+ @details The twiddle factors are evaluated in double precision.
+
+ @param n The number of real samples, a power of two not smaller than 8.
+ */
+FFTPlan::FFTPlan(int n)
+{
+    if (n < 8 or (n & (n - 1)) != 0)
+    {
+        cerr << "!! Error: the size of the transform must be a power of two not smaller than 8, passed value is " << n << endl;
+        exit(0);
+    }
+    n_ = n;
+
+    int m = n / 2;
+    int bits = 0;
+    while ((1 << bits) < m)
+    {
+        ++bits;
+    }
+    rev_.resize(m);
+    for (int k = 0; k < m; ++k)
+    {
+        int r = 0;
+        for (int b = 0; b < bits; ++b)
+        {
+            r |= ((k >> b) & 1) << (bits - 1 - b);
+        }
+        rev_[k] = r;
+    }
+
+    // Stage with butterflies of 2 * half points: half factors exp(-2 pi i j / (2 half)), real parts from 2 (half - 1), then the imaginary parts
+    twiddle_.resize(2 * m);
+    for (int half = 1; half < m; half *= 2)
+    {
+        for (int j = 0; j < half; ++j)
+        {
+            double phi = -M_PI * j / half;
+            twiddle_[2 * (half - 1) + j] = cos(phi);
+            twiddle_[2 * (half - 1) + half + j] = sin(phi);
+        }
+    }
+
+    split_.resize(2 * (m / 2 + 1));
+    for (int k = 0; k <= m / 2; ++k)
+    {
+        double phi = -2 * M_PI * k / n;
+        split_[2 * k] = cos(phi);
+        split_[2 * k + 1] = sin(phi);
+    }
+}
+
+/*!
+ @brief Get the plan of a size.
+
+ @details The plans are built the first time they are requested and kept until the end of the program, the method can be called by many threads.
+
+ @param n The number of real samples.
+ @return const FFTPlan&
+ */
+const FFTPlan &FFTPlan::Get(int n)
+{
+    static map<int, unique_ptr<FFTPlan>> plans;
+    static mutex mtx;
+
+    lock_guard<mutex> lock(mtx);
+    auto &plan = plans[n];
+    if (!plan)
+    {
+        plan = make_unique<FFTPlan>(n);
+    }
+    return *plan;
+}
+
+/*!
+ @brief Get the size of the transform for a waveform.
+
+ @param n The number of samples of the waveform.
+ @return int The smallest power of two not smaller than `n`, and not smaller than 8.
+ */
+int FFTPlan::Size(int n)
+{
+    int size = 8;
+    while (size < n)
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+/*!
+ @brief Evaluate the butterflies of the complex transform.
+
+ @details The real and imaginary parts are kept in two arrays, so that the butterflies of a stage are a loop on contiguous values. The first two stages,
+ with the twiddle factors 1 and \f$ -i\f$, are evaluated together without multiplications.
+
+ @param re The real parts, in bit reversed order. The transform is written in natural order.
+ @param im The imaginary parts.
+ */
+void FFTPlan::Butterflies(float *re, float *im) const
+{
+    int m = n_ / 2;
+    for (int s = 0; s < m; s += 4)
+    {
+        float ar = re[s] + re[s + 1], ai = im[s] + im[s + 1];
+        float br = re[s] - re[s + 1], bi = im[s] - im[s + 1];
+        float cr = re[s + 2] + re[s + 3], ci = im[s + 2] + im[s + 3];
+        float dr = re[s + 2] - re[s + 3], di = im[s + 2] - im[s + 3];
+        re[s] = ar + cr;
+        im[s] = ai + ci;
+        re[s + 2] = ar - cr;
+        im[s + 2] = ai - ci;
+        re[s + 1] = br + di; // d times -i
+        im[s + 1] = bi - dr;
+        re[s + 3] = br - di;
+        im[s + 3] = bi + dr;
+    }
+
+    for (int half = 4; half < m; half *= 2)
+    {
+        const float *wr = twiddle_.data() + 2 * (half - 1);
+        const float *wi = wr + half;
+        for (int start = 0; start < m; start += 2 * half)
+        {
+            float *ar = re + start, *ai = im + start;
+            float *br = ar + half, *bi = ai + half;
+            for (int j = 0; j < half; j += 4) // Four butterflies at a time, loaded before being stored, so that they are vectorised
+            {
+                float xr[4], xi[4], yr[4], yi[4];
+                for (int l = 0; l < 4; ++l)
+                {
+                    float tr = br[j + l] * wr[j + l] - bi[j + l] * wi[j + l];
+                    float ti = br[j + l] * wi[j + l] + bi[j + l] * wr[j + l];
+                    xr[l] = ar[j + l] + tr;
+                    xi[l] = ai[j + l] + ti;
+                    yr[l] = ar[j + l] - tr;
+                    yi[l] = ai[j + l] - ti;
+                }
+                for (int l = 0; l < 4; ++l)
+                {
+                    ar[j + l] = xr[l];
+                    ai[j + l] = xi[l];
+                    br[j + l] = yr[l];
+                    bi[j + l] = yi[l];
+                }
+            }
+        }
+    }
+}
+
+/*!
+ @brief Evaluate the transform of a real waveform.
+
+ @details The transform is \f$ X_k = \sum_{j = 0}^{n - 1} x_j e^{-2 \pi i j k / n}\f$, only the bins from 0 to \f$ n/2\f$ are given, the others being
+ their complex conjugate. The complex transform is evaluated in a buffer of the calling thread, allocated the first time.
+
+ @param x The \f$ n\f$ samples.
+ @param X The \f$ n/2 + 1\f$ bins.
+ */
+void FFTPlan::Forward(const float *x, complex<float> *X) const
+{
+    static thread_local vector<float> work;
+    int m = n_ / 2;
+    work.resize(n_);
+    float *re = work.data(), *im = re + m;
+    for (int k = 0; k < m; ++k)
+    {
+        re[rev_[k]] = x[2 * k];
+        im[rev_[k]] = x[2 * k + 1];
+    }
+    (*this).Butterflies(re, im);
+
+    // Z = E + i O, with E and O the transforms of the even and odd samples: X[k] = E[k] + W^k O[k], X[m - k] = conj(E[k] - W^k O[k])
+    float *d = reinterpret_cast<float *>(X);
+    d[0] = re[0] + im[0];
+    d[1] = 0;
+    d[2 * m] = re[0] - im[0];
+    d[2 * m + 1] = 0;
+    for (int k = 1; k <= m / 2; ++k)
+    {
+        int l = m - k;
+        float er = 0.5f * (re[k] + re[l]), ei = 0.5f * (im[k] - im[l]);
+        float or_ = 0.5f * (im[k] + im[l]), oi = -0.5f * (re[k] - re[l]);
+        float wr = split_[2 * k], wi = split_[2 * k + 1];
+        float tr = wr * or_ - wi * oi, ti = wr * oi + wi * or_;
+        d[2 * k] = er + tr;
+        d[2 * k + 1] = ei + ti;
+        d[2 * l] = er - tr;
+        d[2 * l + 1] = ti - ei;
+    }
+}
+
+/*!
+ @brief Evaluate the waveform from its transform.
+
+ @details The inverse is evaluated as the forward transform of the complex conjugate.
+
+ @param X The \f$ n/2 + 1\f$ bins, as given by @ref FFTPlan::Forward().
+ @param x The \f$ n\f$ samples.
+ */
+void FFTPlan::Inverse(const complex<float> *X, float *x) const
+{
+    static thread_local vector<float> work;
+    int m = n_ / 2;
+    work.resize(n_);
+    float *re = work.data(), *im = re + m;
+    const float *d = reinterpret_cast<const float *>(X);
+
+    // Back to conj(Z), Z = E + i O with E[k] = (X[k] + conj(X[m - k])) / 2 and O[k] = conj(W^k) (X[k] - conj(X[m - k])) / 2
+    re[rev_[0]] = 0.5f * (d[0] + d[2 * m]);
+    im[rev_[0]] = -0.5f * (d[0] - d[2 * m]);
+    for (int k = 1; k <= m / 2; ++k)
+    {
+        int l = m - k;
+        float er = 0.5f * (d[2 * k] + d[2 * l]), ei = 0.5f * (d[2 * k + 1] - d[2 * l + 1]);
+        float dr = 0.5f * (d[2 * k] - d[2 * l]), di = 0.5f * (d[2 * k + 1] + d[2 * l + 1]);
+        float wr = split_[2 * k], wi = -split_[2 * k + 1];
+        float or_ = dr * wr - di * wi, oi = dr * wi + di * wr;
+        re[rev_[k]] = er - oi;
+        im[rev_[k]] = -(ei + or_);
+        re[rev_[l]] = er + oi;
+        im[rev_[l]] = ei - or_;
+    }
+    (*this).Butterflies(re, im);
+
+    float scale = 1.f / m;
+    for (int k = 0; k < m; ++k)
+    {
+        x[2 * k] = re[k] * scale;
+        x[2 * k + 1] = -im[k] * scale;
+    }
+}
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : WaveformSpectrum                                              │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new WaveformSpectrum object.
+
+ @param times The map of \f$ \Delta t\f$ of the ```TIME``` block.
+ @param n_samples The number of samples of the waveforms.
+ @param window The window.
+ */
+WaveformSpectrum::WaveformSpectrum(const MAP &times, int n_samples, Window window) : plan_(FFTPlan::Get(FFTPlan::Size(n_samples))), channels_(times)
+{
+    n_samples_ = n_samples;
+    n_events_ = 0;
+
+    double period = 0;
+    size_t cells = 0;
+    for (auto &[bKey, bVal] : times)
+    {
+        for (auto &[cKey, dt] : bVal)
+        {
+            spectra_.emplace_back(plan_.GetNBins());
+            power_.emplace_back(plan_.GetNBins(), 0);
+            period += accumulate(dt.begin(), dt.end(), 0.);
+            cells += dt.size();
+        }
+    }
+    if (spectra_.empty() or period <= 0)
+    {
+        cerr << "!! Error: no channels to be transformed" << endl;
+        exit(0);
+    }
+    period /= cells;
+
+    int n = plan_.GetSize();
+    window_.resize(n_samples_);
+    norm_ = 0;
+    for (int i = 0; i < n_samples_; ++i)
+    {
+        window_[i] = window == Window::Hann ? pow(sin(M_PI * i / n_samples_), 2) : 1;
+        norm_ += window_[i] * window_[i];
+    }
+    norm_ *= n;
+
+    freq_.resize(plan_.GetNBins());
+    for (int k = 0; k < plan_.GetNBins(); ++k)
+    {
+        freq_[k] = k / (n * period);
+    }
+    buffer_.assign(n, 0);
+}
+
+/*!
+ @brief Evaluate the spectrum of a channel of an event.
+
+ @param event The event.
+ @param b The board.
+ @param c The channel.
+ @return const vector<complex<float>>& The bins, at the frequencies of @ref WaveformSpectrum::GetFrequencies().
+ */
+const vector<complex<float>> &WaveformSpectrum::Transform(DAQEvent &event, int b, int c)
+{
+    int k = channels_.Index(b, c);
+    auto &volts = event.GetChannel(b, c).GetVolts();
+    if ((int)volts.size() != n_samples_)
+    {
+        cerr << "!! Error: waveform of " << volts.size() << " samples, the spectrum expects " << n_samples_ << endl;
+        exit(0);
+    }
+
+    for (int i = 0; i < n_samples_; ++i)
+    {
+        buffer_[i] = volts[i] * window_[i];
+    }
+    plan_.Forward(buffer_.data(), spectra_[k].data());
+    return spectra_[k];
+}
+
+/*!
+ @brief Evaluate the spectra of all the channels of an event.
+
+ @param event The event.
+ @return WaveformSpectrum& The spectra are given by @ref WaveformSpectrum::GetSpectrum().
+ */
+WaveformSpectrum &WaveformSpectrum::Transform(DAQEvent &event)
+{
+    for (auto &[bKey, bVal] : channels_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            (*this).Transform(event, bKey, cKey);
+        }
+    }
+    return *this;
+}
+
+/*!
+ @brief Evaluate the spectra of all the channels of an event and add their power to the power spectra.
+
+ @param event The event.
+ @return WaveformSpectrum&
+ */
+WaveformSpectrum &WaveformSpectrum::Accumulate(DAQEvent &event)
+{
+    (*this).Transform(event);
+    for (size_t k = 0; k < spectra_.size(); ++k)
+    {
+        const float *d = reinterpret_cast<const float *>(spectra_[k].data());
+        double *power = power_[k].data();
+        int n = power_[k].size();
+        for (int i = 0; i < n; ++i)
+        {
+            power[i] += d[2 * i] * d[2 * i] + d[2 * i + 1] * d[2 * i + 1];
+        }
+    }
+    ++n_events_;
+    return *this;
+}
+
+/*!
+ @brief Reset the power spectra.
+
+ @return WaveformSpectrum&
+ */
+WaveformSpectrum &WaveformSpectrum::ResetPower()
+{
+    for (auto &power : power_)
+    {
+        fill(power.begin(), power.end(), 0);
+    }
+    n_events_ = 0;
+    return *this;
+}
+
+/*!
+ @brief Getter method read-only for the last spectrum of a channel.
+
+ @param b The board.
+ @param c The channel.
+ @return const vector<complex<float>>&
+ */
+const vector<complex<float>> &WaveformSpectrum::GetSpectrum(int b, int c)
+{
+    return spectra_[channels_.Index(b, c)];
+}
+
+/*!
+ @brief Getter method for the power spectrum of a channel, averaged over the events accumulated.
+
+ @param b The board.
+ @param c The channel.
+ @return vector<float> The power of each bin, in \f$ V^2\f$.
+ */
+vector<float> WaveformSpectrum::GetPowerSpectrum(int b, int c)
+{
+    auto &power = power_[channels_.Index(b, c)];
+    vector<float> mean(power.size(), 0);
+    if (n_events_ == 0)
+    {
+        return mean;
+    }
+
+    for (size_t k = 0; k < power.size(); ++k)
+    {
+        double scale = (k == 0 or k == power.size() - 1) ? 1 : 2; // One-sided
+        mean[k] = scale * power[k] / (norm_ * n_events_);
+    }
+    return mean;
+}
@@ -0,0 +1,144 @@
+/*!
+ @file readWDSpectrum.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the Fourier transform and of the spectral analysis of the waveforms.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDSPECTRUM_H
+#define READWDSPECTRUM_H
+
+#include "readWD.hh"
+
+#include <complex>
+#include <memory>
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Plan of the Fourier transform of a real waveform with a power of two number of samples.
+
+ @details The transform of \f$ n \f$ real samples is evaluated as the transform of \f$ n/2 \f$ complex samples, the even samples being the real part
+ and the odd samples the imaginary part, followed by a last step that separates the two. The complex transform is a radix-2 Cooley-Tukey: the twiddle
+ factors of each stage and the bit reversal permutation are evaluated once, when the plan is built, and stored contiguously so that the butterflies
+ of a stage are a loop vectorised by the compiler.
+
+ A plan is never modified after being built, so the same plan is used by all the threads. The plans are built once for each size and shared,
+ see @ref FFTPlan::Get().
+
+ @code{.cpp}
+ const FFTPlan &plan = FFTPlan::Get(1024);
+ vector<complex<float>> spectrum(plan.GetNBins());
+ plan.Forward(volts.data(), spectrum.data()); // X[k] = sum x[j] exp(-2 pi i j k / n), k = 0, ..., n/2
+ plan.Inverse(spectrum.data(), volts.data()); // Back to the waveform
+ @endcode
+ */
+class FFTPlan
+{
+public:
+    FFTPlan(int);
+
+    static const FFTPlan &Get(int);
+    static int Size(int);
+
+    void Forward(const float *, std::complex<float> *) const;
+    void Inverse(const std::complex<float> *, float *) const;
+
+    int GetSize() const { return n_; };
+    int GetNBins() const { return n_ / 2 + 1; };
+
+private:
+    void Butterflies(float *, float *) const;
+
+    int n_;                      ///< Number of real samples
+    std::vector<int> rev_;       ///< Bit reversal permutation of the complex transform
+    std::vector<float> twiddle_; ///< Twiddle factors of the complex transform, stage after stage, real parts followed by imaginary parts
+    std::vector<float> split_;   ///< Twiddle factors separating even and odd samples, as real and imaginary parts
+};
+
+/*!
+ @brief Class to evaluate the spectra of the waveforms and the power spectrum averaged over many events.
+
+ @details All the channels of an event are transformed with the same @ref FFTPlan and the spectra are kept in buffers allocated once, so that the
+ transform of each event does not allocate memory. The waveforms are multiplied by a window before the transform, by default the Hann window that
+ reduces the leakage of a noise line into the near bins. A waveform that is not a power of two long (region of interest readout) is padded with zeros.
+
+ With @ref WaveformSpectrum::Accumulate() the power spectrum of each channel is summed over the events, @ref WaveformSpectrum::GetPowerSpectrum() gives
+ the average. The power is one-sided and normalised to the window, so that the sum over the bins is the mean square of the waveform, in \f$ V^2\f$:
+ a sine of amplitude \f$ A\f$ gives \f$ A^2/2\f$ summed over the bins of its line. With the Hann window a line at the centre of a bin spreads over
+ three bins, \f$ A^2/3\f$ in its bin and \f$ A^2/12\f$ in each of the near ones; with @ref WaveformSpectrum::Window::Rectangular the same line is all
+ in its bin.
+
+ The samples are taken as equally spaced with the mean \f$ \Delta t\f$ of the ```TIME``` block: the frequencies are correct within the spread of the
+ \f$ \Delta t\f$, a few percent. To remove the pickup lines from the waveforms see @ref WaveformFilter::Notch() and @ref WaveformFilter::LowPass(), the
+ filters are applied while the events are read. The instance is not shared between threads.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+ WaveformSpectrum spectrum(file);
+
+ while (file >> event)
+ {
+     spectrum.Accumulate(event);
+ }
+ auto &freq = spectrum.GetFrequencies();
+ auto power = spectrum.GetPowerSpectrum(0, 1); // power[k] at frequency freq[k]
+ @endcode
+ */
+class WaveformSpectrum
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+
+public:
+    /*!
+     @brief The window applied to the waveforms before the transform.
+     */
+    enum class Window
+    {
+        Rectangular, ///< No window, the best resolution with the largest leakage.
+        Hann         ///< Hann window, \f$ w_i = \sin^2(\pi i / n)\f$.
+    };
+
+    WaveformSpectrum(const MAP &, int, Window = Window::Hann);
+    /*!
+     @brief Construct a new WaveformSpectrum object for the channels of a file.
+
+     @param file The file, its ```TIME``` block and its number of samples are used.
+     @param window The window.
+     */
+    WaveformSpectrum(DAQFile &file, Window window = Window::Hann) : WaveformSpectrum(file.GetTimeMap(), file.GetNSamples(), window) {}
+
+    const std::vector<std::complex<float>> &Transform(DAQEvent &, int, int);
+    WaveformSpectrum &Transform(DAQEvent &);
+    WaveformSpectrum &Accumulate(DAQEvent &);
+    WaveformSpectrum &ResetPower();
+
+    const std::vector<std::complex<float>> &GetSpectrum(int, int);
+    std::vector<float> GetPowerSpectrum(int, int);
+    const std::vector<float> &GetFrequencies() { return freq_; };
+    int GetNEvents() { return n_events_; };
+
+private:
+
+    const FFTPlan &plan_;                                   ///< The plan of the transform
+    ChannelIndex channels_;                                 ///< Index of each board and channel in the buffers
+    int n_samples_;                                         ///< Number of samples of the waveforms
+    std::vector<float> window_;                             ///< The window
+    double norm_;                                           ///< Normalisation of the power, the sum of the squared window times the size of the transform
+    std::vector<float> freq_;                               ///< The frequencies of the bins, in Hz
+    std::vector<float> buffer_;                             ///< The waveform multiplied by the window and padded
+    std::vector<std::vector<std::complex<float>>> spectra_; ///< The last spectrum of each channel
+    std::vector<std::vector<double>> power_;                ///< The power spectrum of each channel, summed over the events
+    int n_events_;                                          ///< Number of events accumulated
+};
+
+#endif
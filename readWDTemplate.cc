@@ -0,0 +1,458 @@
+/*!
+ @file readWDTemplate.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the template fit of the amplitude and of the time of the pulses.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDTemplate.hh"
+
+using namespace std;
+
+static const int TEMPLATE_PAD = 3;        ///< Copies of the first and last point of a template at its ends.
+static const int TEMPLATE_ITERATIONS = 3; ///< Largest number of Gauss-Newton iterations on the time.
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : TemplateFit                                                   │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new TemplateFit object.
+
+ @details No template is set, see @ref TemplateFit::SetTemplate().
+
+ @param times The map of \f$ \Delta t\f$ of the ```TIME``` block.
+ @param n_samples The number of samples of the waveforms.
+ @param period The period of the grid and of the templates, in seconds.
+ */
+TemplateFit::TemplateFit(const MAP &times, int n_samples, float period) : resampler_(times, n_samples, period, WaveformResampler::Interpolation::Cubic), channels_(times)
+{
+    fits_.resize(channels_.GetNChannels());
+    template_.assign(channels_.GetNChannels(), -1);
+}
+
+/*!
+ @brief Set the template of all the channels.
+
+ @param shape The template, sampled with the period of the grid.
+ @return TemplateFit&
+ */
+TemplateFit &TemplateFit::SetTemplate(const vector<float> &shape)
+{
+    templates_ = {TemplateFit::Build(shape)};
+    fill(template_.begin(), template_.end(), 0);
+    return *this;
+}
+
+/*!
+ @brief Set the template of a channel.
+
+ @param shape The template, sampled with the period of the grid.
+ @param b The board.
+ @param c The channel.
+ @return TemplateFit&
+ */
+TemplateFit &TemplateFit::SetTemplate(const vector<float> &shape, int b, int c)
+{
+    int k = channels_.Index(b, c);
+    templates_.push_back(TemplateFit::Build(shape));
+    template_[k] = templates_.size() - 1;
+    return *this;
+}
+
+/*!
+ @brief Average the pulses of a channel to build a template.
+
+ @details The file is read from the current event to the end, then reset. Each waveform is resampled, its peak is found as the point farthest from
+ its mean and the points around it are added, after subtracting the mean of the first quarter of the points before the peak. The waveforms are
+ aligned on the points of the grid: the template is smeared by one period, which should be small compared to the rise time. The filters set in a
+ configuration are not applied.
+
+ @param file The file.
+ @param b The board.
+ @param c The channel.
+ @param period The period of the grid, in seconds.
+ @param before The time kept before the peak, in seconds.
+ @param after The time kept after the peak, in seconds.
+ @return vector<float> The template.
+ */
+vector<float> TemplateFit::Average(DAQFile &file, int b, int c, float period, float before, float after)
+{
+    if (file.GetType() == "WDB")
+    {
+        return TemplateFit::AverageImpl<WDBEvent>(file, b, c, period, before, after);
+    }
+    return TemplateFit::AverageImpl<DRSEvent>(file, b, c, period, before, after);
+}
+
+/*!
+ @brief Average the pulses of a channel, see @ref TemplateFit::Average().
+
+ @tparam T The type of event of the file.
+ @param file The file.
+ @param b The board.
+ @param c The channel.
+ @param period The period of the grid, in seconds.
+ @param before The time kept before the peak, in seconds.
+ @param after The time kept after the peak, in seconds.
+ @return vector<float>
+ */
+template <typename T>
+vector<float> TemplateFit::AverageImpl(DAQFile &file, int b, int c, float period, float before, float after)
+{
+    T event;
+    WaveformResampler resampler(file, period, WaveformResampler::Interpolation::Cubic);
+    int nb = round(before / period);
+    int na = round(after / period);
+    vector<double> sum(nb + na + 1, 0);
+    long n = 0;
+
+    while (file >> event)
+    {
+        auto &y = resampler.Resample(event, b, c);
+        int m = y.size();
+        float mean = accumulate(y.begin(), y.end(), 0.f) / m;
+        int peak = 0;
+        for (int k = 1; k < m; ++k)
+        {
+            if (abs(y[k] - mean) > abs(y[peak] - mean))
+            {
+                peak = k;
+            }
+        }
+        if (peak - nb < 0 or peak + na >= m)
+        {
+            continue;
+        }
+
+        const float *w = y.data() + peak - nb;
+        float base = accumulate(w, w + nb / 4 + 1, 0.f) / (nb / 4 + 1);
+        for (int k = 0; k <= nb + na; ++k)
+        {
+            sum[k] += w[k] - base;
+        }
+        ++n;
+    }
+    file.Reset();
+
+    if (n == 0)
+    {
+        cerr << "!! Error: no pulse found to build the template" << endl;
+        exit(0);
+    }
+    vector<float> shape(sum.size());
+    for (size_t k = 0; k < sum.size(); ++k)
+    {
+        shape[k] = sum[k] / n;
+    }
+    return shape;
+}
+
+/*!
+ @brief Normalise a template and evaluate its optimal filter.
+
+ @details With \f$ s_k\f$ the template, \f$ s'_k\f$ its derivative and the model \f$ y_k = A s_k - A \delta s'_k + B\f$, the least squares estimate of
+ \f$ (A, -A \delta, B)\f$ is \f$ M^{-1} F y\f$, where the rows of \f$ F\f$ are \f$ s\f$, \f$ s'\f$ and 1 and \f$ M = F F^T\f$. The weights are the
+ rows of \f$ M^{-1} F\f$.
+
+ @param shape The template.
+ @return Template
+ */
+TemplateFit::Template TemplateFit::Build(const vector<float> &shape)
+{
+    int n = shape.size();
+    if (n < 4)
+    {
+        cerr << "!! Error: the template must have at least 4 points, passed size is " << n << endl;
+        exit(0);
+    }
+
+    Template tmpl;
+    tmpl.size = n;
+    tmpl.peak = 0;
+    for (int k = 1; k < n; ++k)
+    {
+        if (abs(shape[k] - shape[0]) > abs(shape[tmpl.peak] - shape[0]))
+        {
+            tmpl.peak = k;
+        }
+    }
+    float height = abs(shape[tmpl.peak] - shape[0]);
+    if (height == 0)
+    {
+        cerr << "!! Error: the template is flat" << endl;
+        exit(0);
+    }
+
+    tmpl.s.resize(n + 2 * TEMPLATE_PAD);
+    for (int k = 0; k < n + 2 * TEMPLATE_PAD; ++k)
+    {
+        int i = min(max(k - TEMPLATE_PAD, 0), n - 1);
+        tmpl.s[k] = (shape[i] - shape[0]) / height;
+    }
+
+    // Basis: template, its derivative and the baseline
+    const float *s = tmpl.s.data() + TEMPLATE_PAD;
+    vector<float> f[3] = {vector<float>(s, s + n), vector<float>(n), vector<float>(n, 1)};
+    for (int k = 0; k < n; ++k)
+    {
+        f[1][k] = 0.5f * (s[k + 1] - s[k - 1]);
+    }
+
+    double M[3][3] = {};
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            M[i][j] = inner_product(f[i].begin(), f[i].end(), f[j].begin(), 0.);
+        }
+    }
+
+    tmpl.weight.assign(3 * n, 0);
+    for (int i = 0; i < 3; ++i)
+    {
+        double unit[3] = {}, row[3];
+        unit[i] = 1;
+        if (!TemplateFit::Solve(M, unit, row))
+        {
+            cerr << "!! Error: the template can not be fitted, the matrix of the optimal filter is singular" << endl;
+            exit(0);
+        }
+        for (int k = 0; k < n; ++k)
+        {
+            tmpl.weight[i * n + k] = row[0] * f[0][k] + row[1] * f[1][k] + row[2] * f[2][k];
+        }
+    }
+    return tmpl;
+}
+
+/*!
+ @brief Solve a system of three linear equations with Cramer's rule.
+
+ @param M The matrix.
+ @param v The known terms.
+ @param x The solution.
+ @return true If the matrix is not singular.
+ */
+bool TemplateFit::Solve(const double M[3][3], const double v[3], double x[3])
+{
+    auto det = [](double a[3][3])
+    {
+        return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+               a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+    };
+
+    double a[3][3];
+    copy(&M[0][0], &M[0][0] + 9, &a[0][0]);
+    double d = det(a);
+    if (d == 0 or !isfinite(d))
+    {
+        return false;
+    }
+    for (int c = 0; c < 3; ++c)
+    {
+        copy(&M[0][0], &M[0][0] + 9, &a[0][0]);
+        for (int r = 0; r < 3; ++r)
+        {
+            a[r][c] = v[r];
+        }
+        x[c] = det(a) / d;
+    }
+    return true;
+}
+
+/*!
+ @brief Fit all the channels of an event with a template.
+
+ @param event The event.
+ @return TemplateFit& The results are given by @ref TemplateFit::GetFit().
+ */
+TemplateFit &TemplateFit::Fit(DAQEvent &event)
+{
+    for (auto &[bKey, bVal] : channels_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            if (template_[cVal] >= 0)
+            {
+                (*this).Fit(event, bKey, cKey);
+            }
+        }
+    }
+    return *this;
+}
+
+/*!
+ @brief Fit a channel of an event with its template.
+
+ @details If the pulse has not the polarity of the template the time is not refined and the amplitude is negative.
+
+ @param event The event.
+ @param b The board.
+ @param c The channel.
+ @return const PulseFit&
+ */
+const PulseFit &TemplateFit::Fit(DAQEvent &event, int b, int c)
+{
+    int ch = channels_.Index(b, c);
+    if (template_[ch] < 0)
+    {
+        cerr << "!! Error: no template set for board-channel (" << b << ", " << c << ")" << endl;
+        exit(0);
+    }
+    const Template &tmpl = templates_[template_[ch]];
+    auto &y = resampler_.Resample(event, b, c);
+    int n = tmpl.size;
+    int m = y.size();
+    if (n > m)
+    {
+        cerr << "!! Error: the template of " << n << " points is longer than the grid of " << m << " points" << endl;
+        exit(0);
+    }
+
+    // Template peak on the waveform peak
+    float sign = tmpl.s[TEMPLATE_PAD + tmpl.peak] > 0 ? 1 : -1;
+    int peak = 0;
+    for (int k = 1; k < m; ++k)
+    {
+        if (sign * y[k] > sign * y[peak])
+        {
+            peak = k;
+        }
+    }
+    int j = min(max(peak - tmpl.peak, 0), m - n);
+
+    // Linear optimal filter, moving the template by one point while the shift is larger than half a point
+    double p[3];
+    int moves = 0;
+    while (true)
+    {
+        const float *w = tmpl.weight.data();
+        const float *x = y.data() + j;
+        for (int i = 0; i < 3; ++i)
+        {
+            double sum = 0;
+            for (int k = 0; k < n; ++k)
+            {
+                sum += w[i * n + k] * x[k];
+            }
+            p[i] = sum;
+        }
+
+        double delta = p[0] > 0 ? -p[1] / p[0] : 0;
+        if (moves < 2 and delta > 0.5 and j < m - n)
+        {
+            ++j;
+        }
+        else if (moves < 2 and delta < -0.5 and j > 0)
+        {
+            --j;
+        }
+        else
+        {
+            break;
+        }
+        ++moves;
+    }
+
+    double A = p[0], B = p[2];
+    double delta = A > 0 ? min(max(-p[1] / A, -1.5), 1.5) : 0;
+
+    // Template and derivative at u = k - delta, interpolated (Catmull-Rom) with weights that are the same for all the points
+    float cw[4], dw[4];
+    auto interpolate = [&tmpl, &cw, &dw](double delta) -> const float *
+    {
+        int q = floor(-delta);
+        float f = -delta - q;
+        cw[0] = (-f * f * f + 2 * f * f - f) / 2;
+        cw[1] = (3 * f * f * f - 5 * f * f + 2) / 2;
+        cw[2] = (-3 * f * f * f + 4 * f * f + f) / 2;
+        cw[3] = (f * f * f - f * f) / 2;
+        dw[0] = (-3 * f * f + 4 * f - 1) / 2;
+        dw[1] = (9 * f * f - 10 * f) / 2;
+        dw[2] = (-9 * f * f + 8 * f + 1) / 2;
+        dw[3] = (3 * f * f - 2 * f) / 2;
+        return tmpl.s.data() + TEMPLATE_PAD + q - 1;
+    };
+
+    // Gauss-Newton on the time, only for pulses with the polarity of the template
+    const float *x = y.data() + j;
+    for (int it = 0; it < TEMPLATE_ITERATIONS and A > 0; ++it)
+    {
+        const float *s = interpolate(delta);
+        double ss = 0, sd = 0, dd = 0, s1 = 0, d1 = 0, ys = 0, yd = 0, y1 = 0;
+        for (int k = 0; k < n; ++k)
+        {
+            float sk = cw[0] * s[k] + cw[1] * s[k + 1] + cw[2] * s[k + 2] + cw[3] * s[k + 3];
+            float dk = dw[0] * s[k] + dw[1] * s[k + 1] + dw[2] * s[k + 2] + dw[3] * s[k + 3];
+            ss += sk * sk;
+            sd += sk * dk;
+            dd += dk * dk;
+            s1 += sk;
+            d1 += dk;
+            ys += x[k] * sk;
+            yd += x[k] * dk;
+            y1 += x[k];
+        }
+
+        double M[3][3] = {{ss, sd, s1}, {sd, dd, d1}, {s1, d1, (double)n}};
+        double v[3] = {ys, yd, y1};
+        if (!TemplateFit::Solve(M, v, p) or p[0] <= 0)
+        {
+            break;
+        }
+        double step = -p[1] / p[0];
+        delta = min(max(delta + step, -1.5), 1.5);
+        if (abs(step) < 1e-3)
+        {
+            break;
+        }
+    }
+    if (A <= 0)
+    {
+        delta = 0;
+    }
+
+    // Amplitude, baseline and residuals at the final time
+    const float *s = interpolate(delta);
+    double ss = 0, s1 = 0, ys = 0, y1 = 0, yy = 0;
+    for (int k = 0; k < n; ++k)
+    {
+        float sk = cw[0] * s[k] + cw[1] * s[k + 1] + cw[2] * s[k + 2] + cw[3] * s[k + 3];
+        ss += sk * sk;
+        s1 += sk;
+        ys += x[k] * sk;
+        y1 += x[k];
+        yy += x[k] * x[k];
+    }
+    double det = ss * n - s1 * s1;
+    if (det != 0)
+    {
+        A = (ys * n - s1 * y1) / det;
+        B = (ss * y1 - s1 * ys) / det;
+    }
+
+    auto &grid = resampler_.GetTimes();
+    fits_[ch].amplitude = A;
+    fits_[ch].baseline = B;
+    fits_[ch].chi2 = max(yy - A * ys - B * y1, 0.) / max(n - 3, 1);
+    fits_[ch].time = grid[j + tmpl.peak] + delta * resampler_.GetPeriod();
+    return fits_[ch];
+}
+
+/*!
+ @brief Getter method read-only for the last fit of a channel.
+
+ @param b The board.
+ @param c The channel.
+ @return const PulseFit&
+ */
+const PulseFit &TemplateFit::GetFit(int b, int c)
+{
+    return fits_[channels_.Index(b, c)];
+}
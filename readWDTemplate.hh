@@ -0,0 +1,116 @@
+/*!
+ @file readWDTemplate.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the template fit of the amplitude and of the time of the pulses.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDTEMPLATE_H
+#define READWDTEMPLATE_H
+
+#include "readWDResample.hh"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ STRUCTURES                                                              │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Result of the template fit of a waveform.
+ */
+struct PulseFit
+{
+    float amplitude; ///< The height of the pulse in Volts, positive if the pulse has the polarity of the template.
+    float time;      ///< The time of the peak of the template, in seconds.
+    float baseline;  ///< The baseline in Volts.
+    float chi2;      ///< The sum of the squared residuals over the number of degrees of freedom, in \f$ V^2\f$.
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Class to fit the amplitude and the time of the pulses with a template.
+
+ @details The waveform is modelled as \f$ y(t) = A\, s(t - \tau) + B\f$, with \f$ s\f$ the template of the channel. Amplitude, time and baseline use
+ all the samples of the pulse, so they are less affected by the noise than @ref DAQEvent::GetAmplitude(), a single sample, and @ref DAQEvent::GetTimeCF(),
+ an interpolation between two samples. For each channel:
+    -# the waveform is resampled on a uniform grid with the period of the templates, see @ref WaveformResampler;
+    -# the template is placed with its peak on the peak of the waveform and \f$ A\f$, \f$ B\f$ and a shift are evaluated by a linear optimal filter:
+       expanding \f$ s(t - \tau)\f$ to first order, the least squares solution is a weighted sum of the samples, with weights evaluated once
+       for each template. If the shift is larger than half a point the template is moved by one point and the filter applied again;
+    -# the time is refined with a few Gauss-Newton iterations, the template being interpolated between its points.
+
+ A template is a pulse sampled with the period of the grid and starting on the baseline: it is normalised to a peak of \f$ \pm 1\f$ with respect to its
+ first point, so that the amplitude is the height of the pulse in Volts. A template can be given or averaged over the events of a file with
+ @ref TemplateFit::Average(). The fit is done on all the channels with a template in one call, @ref TemplateFit::Fit(DAQEvent &). The instance is not
+ shared between threads.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+ TemplateFit fit(file, 0.1e-9);
+
+ fit.SetTemplate(TemplateFit::Average(file, 0, 1, 0.1e-9, 5e-9, 20e-9)); // Same template for all the channels
+ while (file >> event)
+ {
+     fit.Fit(event);
+     float amplitude = fit.GetFit(0, 1).amplitude;
+ }
+ @endcode
+ */
+class TemplateFit
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+
+public:
+    TemplateFit(const MAP &, int, float);
+    /*!
+     @brief Construct a new TemplateFit object for the channels of a file.
+
+     @param file The file, its ```TIME``` block and its number of samples are used.
+     @param period The period of the grid and of the templates, in seconds.
+     */
+    TemplateFit(DAQFile &file, float period) : TemplateFit(file.GetTimeMap(), file.GetNSamples(), period) {}
+
+    TemplateFit &SetTemplate(const std::vector<float> &);
+    TemplateFit &SetTemplate(const std::vector<float> &, int, int);
+    static std::vector<float> Average(DAQFile &, int, int, float, float, float);
+
+    TemplateFit &Fit(DAQEvent &);
+    const PulseFit &Fit(DAQEvent &, int, int);
+    const PulseFit &GetFit(int, int);
+
+private:
+    /*!
+     @brief A template with its optimal filter.
+     */
+    struct Template
+    {
+        std::vector<float> s;      ///< The normalised template, with 3 copies of the first and last point at its ends.
+        std::vector<float> weight; ///< The weights of the optimal filter, for \f$ A\f$, \f$ -A \delta\f$ and \f$ B\f$, one block each.
+        int size;                  ///< The number of points.
+        int peak;                  ///< The index of the peak.
+    };
+
+    template <typename T>
+    static std::vector<float> AverageImpl(DAQFile &, int, int, float, float, float);
+    static Template Build(const std::vector<float> &);
+    static bool Solve(const double[3][3], const double[3], double[3]);
+
+    WaveformResampler resampler_;                ///< Resampler on the grid of the templates
+    ChannelIndex channels_;                      ///< Index of each board and channel in the results
+    std::vector<Template> templates_;            ///< The templates
+    std::vector<int> template_;                  ///< The index of the template of each channel, -1 if not set
+    std::vector<PulseFit> fits_;                 ///< The last fit of each channel
+};
+
+#endif
@@ -0,0 +1,184 @@
+/*!
+ @file readWDTiming.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Definition of the times of the edges of the pulses at many levels.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+#include "readWDTiming.hh"
+
+using namespace std;
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES : EdgeTiming                                                    │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Construct a new EdgeTiming object.
+
+ @param times The map of \f$ \Delta t\f$ of the ```TIME``` block, only the boards and channels are used.
+ @param thresholds The thresholds in Volts.
+ @param fractions The fractions of the amplitude.
+ */
+EdgeTiming::EdgeTiming(const MAP &times, const vector<float> &thresholds, const vector<float> &fractions) : channels_(times)
+{
+    edges_.resize(channels_.GetNChannels());
+    if (edges_.empty())
+    {
+        cerr << "!! Error: no channels to be analysed" << endl;
+        exit(0);
+    }
+
+    (*this).SetLevels(thresholds, fractions);
+}
+
+/*!
+ @brief Set the levels.
+
+ @details The times are given in the same order, the thresholds first and then the fractions.
+
+ @param thresholds The thresholds in Volts.
+ @param fractions The fractions of the amplitude, in range (0, 1].
+ @return EdgeTiming&
+ */
+EdgeTiming &EdgeTiming::SetLevels(const vector<float> &thresholds, const vector<float> &fractions)
+{
+    if (thresholds.empty() and fractions.empty())
+    {
+        cerr << "!! Error: no levels given" << endl;
+        exit(0);
+    }
+    for (auto fraction : fractions)
+    {
+        if (fraction <= 0 or fraction > 1)
+        {
+            cerr << "!! Error: CF value must be in range (0, 1]" << endl;
+            exit(0);
+        }
+    }
+
+    thresholds_ = thresholds;
+    fractions_ = fractions;
+    size_t n_levels = thresholds_.size() + fractions_.size();
+    height_.resize(n_levels);
+    order_.resize(n_levels);
+    for (auto &edges : edges_)
+    {
+        edges.resize(n_levels);
+    }
+    return *this;
+}
+
+/*!
+ @brief Evaluate the times of the edges of a channel of an event.
+
+ @details The waveform is taken with the sign of the amplitude, so that the pulse is positive, and the height of each level from the pedestal is
+ evaluated. Walking back from the peak, the highest level is met first: the walk goes on from where the previous level was crossed.
+
+ @param event The event.
+ @param b The board.
+ @param c The channel.
+ @return const vector<EdgeTimes>& The times of each level, the thresholds first and then the fractions.
+ */
+const vector<EdgeTimes> &EdgeTiming::Evaluate(DAQEvent &event, int b, int c)
+{
+    auto &edges = edges_[channels_.Index(b, c)];
+
+    float ped = event.GetChannel(b, c).GetPedestal().first;
+    int peak = event.GetChannel(b, c).GetPeakIndices()[0];
+    auto &volts = event.GetChannel(b, c).GetVolts();
+    auto &times = event.GetChannel(b, c).GetTimes();
+    int n = volts.size();
+
+    float amplitude = volts[peak] - ped;
+    float sign = amplitude < 0 ? -1 : 1;
+    auto y = [&](int i) -> float
+    { return sign * (volts[i] - ped); };
+
+    size_t n_thr = thresholds_.size();
+    for (size_t l = 0; l < order_.size(); ++l)
+    {
+        height_[l] = l < n_thr ? sign * (thresholds_[l] - ped) : fractions_[l - n_thr] * abs(amplitude);
+        order_[l] = l;
+        edges[l] = {0, 0};
+    }
+    sort(order_.begin(), order_.end(), [this](int a, int b)
+         { return height_[a] > height_[b]; });
+
+    int first = min(10, peak), last = max(n - 11, peak);
+    int lead = peak, trail = peak;
+    for (int l : order_)
+    {
+        float h = height_[l];
+        if (h <= 0)
+        {
+            break; // This level and the following ones are on the other side of the pedestal
+        }
+        if (h > y(peak))
+        {
+            continue;
+        }
+
+        while (lead > first and y(lead) > h)
+        {
+            --lead;
+        }
+        if (y(lead) <= h and lead < peak)
+        {
+            edges[l].leading = times[lead] + (h - y(lead)) * (times[lead + 1] - times[lead]) / (y(lead + 1) - y(lead));
+        }
+        else if (lead == peak and y(peak) == h) // The level is at the peak, a walk that could not move leaves the null time
+        {
+            edges[l].leading = times[peak];
+        }
+
+        while (trail < last and y(trail) > h)
+        {
+            ++trail;
+        }
+        if (y(trail) <= h and trail > peak)
+        {
+            edges[l].trailing = times[trail - 1] + (h - y(trail - 1)) * (times[trail] - times[trail - 1]) / (y(trail) - y(trail - 1));
+        }
+        else if (trail == peak and y(peak) == h) // The level is at the peak, a walk that could not move leaves the null time
+        {
+            edges[l].trailing = times[peak];
+        }
+    }
+    return edges;
+}
+
+/*!
+ @brief Evaluate the times of the edges of all the channels of an event.
+
+ @param event The event.
+ @return EdgeTiming& The times are given by @ref EdgeTiming::GetEdges().
+ */
+EdgeTiming &EdgeTiming::Evaluate(DAQEvent &event)
+{
+    for (auto &[bKey, bVal] : channels_)
+    {
+        for (auto &[cKey, cVal] : bVal)
+        {
+            (*this).Evaluate(event, bKey, cKey);
+        }
+    }
+    return *this;
+}
+
+/*!
+ @brief Getter method read-only for the times of the edges of a channel found in the last event.
+
+ @param b The board.
+ @param c The channel.
+ @return const vector<EdgeTimes>&
+ */
+const vector<EdgeTimes> &EdgeTiming::GetEdges(int b, int c)
+{
+    return edges_[channels_.Index(b, c)];
+}
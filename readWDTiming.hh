@@ -0,0 +1,96 @@
+/*!
+ @file readWDTiming.hh
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Declaration of the times of the edges of the pulses at many levels.
+ @version 0.1
+ @date 2026-10-19
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#ifndef READWDTIMING_H
+#define READWDTIMING_H
+
+#include "readWD.hh"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ STRUCTURES                                                              │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief The times at which the pulse crosses a level.
+ */
+struct EdgeTimes
+{
+    float leading;  ///< The time of the crossing on the leading edge in seconds, 0 if the level is not crossed.
+    float trailing; ///< The time of the crossing on the trailing edge in seconds, 0 if the level is not crossed.
+};
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────────┐
+  │ CLASSES                                                                 │
+  └─────────────────────────────────────────────────────────────────────────┘
+ */
+
+/*!
+ @brief Class to evaluate the times of the leading and trailing edges of the pulse at many thresholds and constant fractions.
+
+ @details The levels are absolute thresholds in Volts, as in @ref DAQEvent::GetTime(), and fractions of the amplitude, as in @ref DAQEvent::GetTimeCF().
+ They are crossed by the pulse of @ref DAQEvent::FindPeaks(), with the pedestal and the peak already evaluated for the event. All the levels are found
+ with one walk from the peak back to the leading edge and one from the peak forward to the trailing edge: the levels are sorted by their height, so
+ each sample is read at most once whatever the number of levels, and the walks stop at the lowest level. The crossings are the closest to the peak
+ and the time is interpolated between the two samples around the crossing. A level on the other side of the pedestal or beyond the peak is not
+ crossed, and a level not crossed before the 10th sample or after the 10th to last sample gets a null time.
+
+ The levels are the same for all the channels, the times of all the channels of an event are evaluated with one call. The instance is not shared
+ between threads.
+
+ @code{.cpp}
+ DAQFile file("path/to/data.dat");
+ DRSEvent event;
+ EdgeTiming timing(file, {-0.01, -0.02, -0.05}, {0.1, 0.5, 0.9}); // Three thresholds and three fractions
+
+ while (file >> event)
+ {
+     auto &edges = timing.Evaluate(event, 0, 1);   // edges[0..2] for the thresholds, edges[3..5] for the fractions
+     float rise = edges[5].leading - edges[3].leading; // 10% - 90% rise time
+     float width = edges[4].trailing - edges[4].leading; // Full width at half maximum
+ }
+ @endcode
+ */
+class EdgeTiming
+{
+    using MAP = std::map<int, std::map<int, std::vector<float>>>; ///< Alias for data structure.
+
+public:
+    EdgeTiming(const MAP &, const std::vector<float> &, const std::vector<float> & = {});
+    /*!
+     @brief Construct a new EdgeTiming object for the channels of a file.
+
+     @param file The file, its ```TIME``` block is used.
+     @param thresholds The thresholds in Volts.
+     @param fractions The fractions of the amplitude.
+     */
+    EdgeTiming(DAQFile &file, const std::vector<float> &thresholds, const std::vector<float> &fractions = {})
+        : EdgeTiming(file.GetTimeMap(), thresholds, fractions) {}
+
+    EdgeTiming &SetLevels(const std::vector<float> &, const std::vector<float> & = {});
+
+    const std::vector<EdgeTimes> &Evaluate(DAQEvent &, int, int);
+    EdgeTiming &Evaluate(DAQEvent &);
+    const std::vector<EdgeTimes> &GetEdges(int, int);
+
+private:
+
+    ChannelIndex channels_;                      ///< Index of each board and channel in the buffers
+    std::vector<float> thresholds_;              ///< The thresholds, in Volts
+    std::vector<float> fractions_;               ///< The fractions of the amplitude
+    std::vector<float> height_;                  ///< The height of each level from the pedestal, towards the peak
+    std::vector<int> order_;                     ///< The levels sorted from the highest to the lowest
+    std::vector<std::vector<EdgeTimes>> edges_;  ///< The times of each channel, thresholds first
+};
+
+#endif
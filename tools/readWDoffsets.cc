@@ -0,0 +1,120 @@
+/*!
+ @file readWDoffsets.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Command line tool to write the table of the offsets of the cells from pedestal runs.
+ @version 0.1
+ @date 2026-10-19
+
+ @details The pedestal runs given on the command line are read in one pass, in parallel with @ref DAQDataset::Process(): each thread averages the
+ cells of its files with its own @ref WaveformAverage, the averages are then merged and the table of @ref OffsetCalibration is written. For each
+ channel the spread of the offsets and the mean noise of the cells are printed. The option `-o` sets the name of the table, `offsets.txt` by default,
+ the option `-j` the number of threads, all the cores by default.
+
+ @code{.sh}
+ readWDoffsets -o offsets.txt path/to/pedestal*.dat
+ @endcode
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#include "../readWDAverage.hh"
+#include "../readWDDataset.hh"
+
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+/*!
+ @brief Average the cells of all the files of a dataset, in parallel.
+
+ @tparam T The type of event of the files.
+ @param dataset The pedestal runs.
+ @param file The first run, for the channels and the number of samples.
+ @param n_threads The number of threads.
+ @return WaveformAverage
+ */
+template <typename T>
+WaveformAverage AverageCells(DAQDataset &dataset, DAQFile &file, unsigned int n_threads)
+{
+    vector<WaveformAverage> partial(n_threads, WaveformAverage(file, WaveformAverage::Alignment::Cell));
+    dataset.Process([&](T &event, long, unsigned int thread)
+                    { partial[thread].Add(event); }, n_threads);
+    for (unsigned int t = 1; t < n_threads; ++t)
+    {
+        partial[0].Merge(partial[t]);
+    }
+    return partial[0];
+}
+
+int main(int argc, char **argv)
+{
+    string out = "offsets.txt";
+    unsigned int n_threads = 0;
+    vector<string> fnames;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-o") == 0 and i + 1 < argc)
+        {
+            out = argv[++i];
+        }
+        else if (strcmp(argv[i], "-j") == 0 and i + 1 < argc)
+        {
+            n_threads = atoi(argv[++i]);
+        }
+        else
+        {
+            fnames.push_back(argv[i]);
+        }
+    }
+
+    if (fnames.empty())
+    {
+        cerr << "Usage: " << argv[0] << " [-o table] [-j threads] pedestal1 [pedestal2 ...]" << endl;
+        return 1;
+    }
+    if (n_threads == 0)
+    {
+        n_threads = max(1u, thread::hardware_concurrency());
+    }
+
+    // The messages printed while opening the files are not part of the output
+    ostringstream log;
+    auto buf = cout.rdbuf(log.rdbuf());
+    DAQFile file(fnames[0]);
+    DAQDataset dataset(fnames);
+    auto average = file.GetType() == "WDB" ? AverageCells<WDBEvent>(dataset, file, n_threads) : AverageCells<DRSEvent>(dataset, file, n_threads);
+    cout.rdbuf(buf);
+
+    OffsetCalibration calibration(average);
+    calibration.Write(out);
+
+    cout << "board channel waveforms offset_rms[V] noise[V]" << endl;
+    for (auto &[b, c] : average.GetChannels())
+    {
+        if (!calibration.HasOffsets(b, c))
+        {
+            continue;
+        }
+
+        auto &offsets = calibration.GetOffsets(b, c);
+        auto noise = average.GetRMS(b, c);
+        auto entries = average.GetEntries(b, c);
+        double spread = 0, rms = 0;
+        long filled = 0;
+        for (size_t k = 0; k < offsets.size(); ++k)
+        {
+            if (entries[k] > 0)
+            {
+                spread += offsets[k] * offsets[k];
+                rms += noise[k];
+                ++filled;
+            }
+        }
+        cout << b << " " << c << " " << average.GetNWaveforms(b, c) << " " << sqrt(spread / filled) << " " << rms / filled << endl;
+    }
+    cout << "Offsets written to " << out << endl;
+
+    return 0;
+}
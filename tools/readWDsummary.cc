@@ -0,0 +1,93 @@
+/*!
+ @file readWDsummary.cc
+ @author Matteo Brini (brinimatteo@gmail.com)
+ @brief Command line tool to print the summary of many files.
+ @version 0.1
+ @date 2026-10-19
+
+ @details For each file given on the command line the summary evaluated by @ref DAQFile::Scan() is printed. Only the event headers are read,
+ so the tool can be run over thousands of files. With the option `-c` one line of comma-separated values is printed for each file.
+
+ @code{.sh}
+ readWDsummary path/to/run*.dat
+ readWDsummary -c path/to/run*.dat > runs.csv
+ @endcode
+
+ @copyright Copyright (c) 2023
+
+ */
+
+#include "../readWD.hh"
+
+#include <sstream>
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+    bool csv = false;
+    vector<string> fnames;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-c") == 0)
+        {
+            csv = true;
+        }
+        else
+        {
+            fnames.push_back(argv[i]);
+        }
+    }
+
+    if (fnames.empty())
+    {
+        cerr << "Usage: " << argv[0] << " [-c] file1 [file2 ...]" << endl;
+        return 1;
+    }
+
+    if (csv)
+    {
+        cout << "file,type,n_events,truncated,first_serial,last_serial,time_span,rate,boards,channels,gaps,missing" << endl;
+    }
+
+    for (auto &fname : fnames)
+    {
+        // The messages printed while opening the file are not part of the summary
+        ostringstream log;
+        auto buf = cout.rdbuf(log.rdbuf());
+        DAQFile file(fname);
+        DAQSummary summary = file.Scan();
+        cout.rdbuf(buf);
+
+        if (!csv)
+        {
+            cout << summary << endl
+                 << endl;
+            continue;
+        }
+
+        unsigned long missing = 0;
+        for (auto &[before, after] : summary.gaps)
+        {
+            missing += after > before ? after - before - 1 : 0;
+        }
+
+        cout << summary.filename << "," << summary.type << (summary.is_lab ? "-LAB" : "") << "," << summary.n_events << "," << summary.truncated << ","
+             << summary.first.serialNumber << "," << summary.last.serialNumber << "," << summary.time_span << "," << summary.rate << ",";
+        for (size_t i = 0; i < summary.board_serials.size(); ++i)
+        {
+            cout << (i ? " " : "") << summary.board_serials[i];
+        }
+        cout << ",";
+        for (auto &[b, channels] : summary.channels)
+        {
+            for (size_t j = 0; j < channels.size(); ++j)
+            {
+                cout << (b or j ? " " : "") << b << ":" << channels[j];
+            }
+        }
+        cout << "," << summary.gaps.size() << "," << missing << endl;
+    }
+
+    return 0;
+}